@@ -27,7 +27,9 @@ void FOmniSyncModule::StartupModule()
 	PropertyModule.RegisterCustomClassLayout( UOmniSyncSettings::StaticClass()->GetFName(),
 	                                          FOnGetDetailCustomizationInstance::CreateStatic( &FOmniSyncCustomization::MakeInstance ) );
 
-	UOmniSyncSettings::Get()->Initialize();
+	// The commandlet drives syncing itself and must not leave watchers or tickers behind
+	if( !IsRunningCommandlet() )
+		UOmniSyncSettings::Get()->Initialize();
 }
 
 void FOmniSyncModule::ShutdownModule()
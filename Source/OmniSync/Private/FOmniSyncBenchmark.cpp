@@ -0,0 +1,448 @@
+#include "FOmniSyncBenchmark.h"
+
+#include "Dom/JsonObject.h"
+#include "FOmniSync.h"
+#include "FOmniSyncDirectoryIndex.h"
+#include "FOmniSyncManifest.h"
+#include "FOmniSyncSettingsStore.h"
+#include "FOmniSyncWorker.h"
+#include "Framework/Application/SlateApplication.h"
+#include "IDetailsView.h"
+#include "Macros.h"
+#include "PropertyEditorModule.h"
+#include "Serialization/JsonSerializer.h"
+#include "UOmniSyncSettings.h"
+
+namespace
+{
+	void RunBenchmark( const TArray< FString >& Args )
+	{
+		const FString Command = FString::Join( Args, TEXT( " " ) );
+
+		FString SizesText = TEXT( "10,1000,10000" );
+		FParse::Value( *Command, TEXT( "Sizes=" ), SizesText, false );
+
+		int32 Iterations = 3;
+		FParse::Value( *Command, TEXT( "Iterations=" ), Iterations );
+
+		FString OutputFile = FPaths::Combine( FPaths::ProjectSavedDir(), TEXT( "OmniSyncBenchmark" ), TEXT( "Results.json" ) );
+		FParse::Value( *Command, TEXT( "Output=" ), OutputFile );
+
+		FString BaselineFile = FOmniSyncBenchmark::GetDefaultBaselineFile();
+		FParse::Value( *Command, TEXT( "Baseline=" ), BaselineFile );
+
+		double Tolerance = 1.5;
+		FParse::Value( *Command, TEXT( "Tolerance=" ), Tolerance );
+
+		TArray< FString > SizeParts;
+		SizesText.ParseIntoArray( SizeParts, TEXT( "," ) );
+
+		TArray< int32 > Sizes;
+		for( const FString& SizePart: SizeParts )
+		{
+			if( const int32 Size = FCString::Atoi( *SizePart ); Size > 0 )
+				Sizes.Add( Size );
+		}
+
+		const TArray< FOmniSyncBenchmarkResult > Results = FOmniSyncBenchmark::Run( Sizes, FMath::Max( Iterations, 1 ) );
+		if( FOmniSyncBenchmark::WriteJson( Results, FMath::Max( Iterations, 1 ), OutputFile ) )
+			UE_LOG( OmniSync, Display, TEXT( "Benchmark results written to %s" ), *OutputFile );
+
+		TArray< FOmniSyncBenchmarkRegression > Regressions;
+		if( !FOmniSyncBenchmark::FindRegressions( Results, BaselineFile, Tolerance, Regressions ) )
+			return;
+
+		for( const FOmniSyncBenchmarkRegression& Regression: Regressions )
+		{
+			UE_LOG( OmniSync,
+			        Warning,
+			        TEXT( "Regression: %s with %d files took %.3f ms, the baseline median is %.3f ms" ),
+			        *Regression.Operation,
+			        Regression.NumFiles,
+			        Regression.MedianMs,
+			        Regression.BaselineMedianMs );
+		}
+
+		UE_LOG( OmniSync, Display, TEXT( "%d regressions against %s" ), Regressions.Num(), *BaselineFile );
+	}
+
+	FAutoConsoleCommand BenchmarkCommand( TEXT( "OmniSync.Benchmark" ),
+	                                      TEXT( "Times discovery, settings persistence, syncing and the settings panel on synthetic projects and compares them "
+		                                      "against a baseline results file. Usage: OmniSync.Benchmark [Sizes=10,1000,10000] [Iterations=3] [Output=<File>] "
+		                                      "[Baseline=<File>] [Tolerance=1.5]" ),
+	                                      FConsoleCommandWithArgsDelegate::CreateStatic( &RunBenchmark ) );
+
+	// Sub-millisecond operations jitter by more than any tolerance, a regression has to cost at least this much
+	constexpr double RegressionFloorMs = 1.0;
+
+	template< typename T >
+	T GetMedian( TArray< T > Samples )
+	{
+		if( Samples.IsEmpty() )
+			return T();
+
+		Samples.Sort();
+		const int32 Middle = Samples.Num() / 2;
+		return Samples.Num() % 2 ? Samples[ Middle ] : ( Samples[ Middle - 1 ] + Samples[ Middle ] ) / 2;
+	}
+
+	FString GetResultKey( const FString& Operation, const int32 NumFiles )
+	{
+		return FString::Printf( TEXT( "%s@%d" ), *Operation, NumFiles );
+	}
+}
+
+FOmniSyncScopedStoreRoot::FOmniSyncScopedStoreRoot( const FString& Directory )
+	: PreviousRoot( UOmniSyncSettings::ScopedStoreRoot )
+{
+	TRACE_CPU_SCOPE;
+	check( IsInGameThread() );
+
+	// Jobs resolve store paths on the worker, none of the editor's may be in flight while the root changes under them
+	if( UOmniSyncSettings::Instance )
+		UOmniSyncSettings::Instance->WaitUntilIdle();
+
+	UOmniSyncSettings::ScopedStoreRoot = FPaths::ConvertRelativePathToFull( Directory );
+}
+
+FOmniSyncScopedStoreRoot::~FOmniSyncScopedStoreRoot()
+{
+	TRACE_CPU_SCOPE;
+	check( IsInGameThread() );
+
+	UOmniSyncSettings::ScopedStoreRoot = PreviousRoot;
+}
+
+FOmniSyncSandbox::FOmniSyncSandbox( const int32 InNumFiles )
+	: Root( FPaths::Combine( FPaths::ProjectSavedDir(), TEXT( "OmniSyncBenchmark" ), FString::FromInt( InNumFiles ) ) )
+	, NumFiles( InNumFiles )
+{
+	TRACE_CPU_SCOPE;
+
+	// Saved/OmniSyncBenchmark is outside the discovery roots, the real project never picks these files up
+	IFileManager::Get().DeleteDirectory( *Root, false, true );
+
+	for( int32 Index = 0; Index < NumFiles; ++Index )
+	{
+		FString Text = FString::Printf( TEXT( "[/Script/OmniSyncBenchmark.Settings%d]\n" ), Index );
+		for( int32 Key = 0; Key < 8; ++Key )
+			Text += FString::Printf( TEXT( "Key%d=Value%d_%d\n" ), Key, Index, Key );
+		Text += TEXT( "+Entries=First\n+Entries=Second\n" );
+
+		FFileHelper::SaveStringToFile( Text, *GetLocalFile( Index ) );
+	}
+
+	Roots = {
+		{ FPaths::Combine( Root, TEXT( "Config" ) ), false },
+		{ FPaths::Combine( Root, TEXT( "Plugins" ) ), true },
+	};
+
+	// Pushing and pulling writes the synthetic files into the store, which must not be the one the team syncs through
+	StoreRoot = MakeUnique< FOmniSyncScopedStoreRoot >( FPaths::Combine( Root, TEXT( "Store" ) ) );
+
+	// The sandbox starts from the class defaults, which hold the live settings, and keeps its own state next to the synthetic files
+	const FString StateDir = FPaths::Combine( Root, TEXT( "State" ) );
+
+	Settings = NewObject< UOmniSyncSettings >( GetTransientPackage() );
+	Settings->AddToRoot();
+	Settings->ConfigFileSettingsStruct                 = FConfigFileSettingsStruct();
+	Settings->ConfigFileSettingsStruct.bHotApplyOnLoad = false;
+	Settings->RebuildSettingsIndex();
+	Settings->SettingsStore  = MakeShared< FOmniSyncSettingsStore >( StateDir );
+	Settings->DirectoryIndex = MakeShared< FOmniSyncDirectoryIndex >( FPaths::Combine( StateDir, TEXT( "OmniSyncDirectoryIndex.json" ) ) );
+	Settings->LocalManifest  = MakeShared< FOmniSyncManifest >( FPaths::Combine( StateDir, TEXT( "OmniSyncLocalManifest.json" ) ) );
+}
+
+FOmniSyncSandbox::~FOmniSyncSandbox()
+{
+	TRACE_CPU_SCOPE;
+
+	// The store root stays redirected until the sandbox's worker has stopped
+	Settings->Shutdown();
+	Settings->RemoveFromRoot();
+	StoreRoot.Reset();
+
+	IFileManager::Get().DeleteDirectory( *Root, false, true );
+}
+
+FString FOmniSyncSandbox::GetLocalFile( const int32 Index ) const
+{
+	// A few project level files, the rest spread over nested plugin folders like a marketplace heavy project
+	constexpr int32 FilesPerPlugin  = 8;
+	constexpr int32 PluginsPerGroup = 16;
+	const int32     NumProjectFiles = FMath::Clamp( NumFiles / 20, 1, NumFiles );
+	const FString   FileName        = FString::Printf( TEXT( "DefaultBenchmark%d.ini" ), Index );
+
+	if( Index < NumProjectFiles )
+		return FPaths::Combine( Root, TEXT( "Config" ), FileName );
+
+	const int32 Plugin = ( Index - NumProjectFiles ) / FilesPerPlugin;
+	return FPaths::Combine( Root, TEXT( "Plugins" ), FString::Printf( TEXT( "Group%d" ), Plugin / PluginsPerGroup ), FString::Printf( TEXT( "Plugin%d" ), Plugin ), TEXT( "Config" ), FileName );
+}
+
+FString FOmniSyncSandbox::GetRelativePath( const int32 Index ) const
+{
+	FString RelativePath = GetLocalFile( Index );
+	FPaths::MakePathRelativeTo( RelativePath, *FPaths::ProjectDir() );
+	return RelativePath;
+}
+
+void FOmniSyncSandbox::Discover()
+{
+	Settings->DiscoverAndAddConfigFiles( Roots );
+}
+
+void FOmniSyncSandbox::EnableAll()
+{
+	for( FConfigFileSettings& Setting: Settings->ConfigFileSettingsStruct.Settings )
+	{
+		Setting.bEnabled         = true;
+		Setting.bAutoSyncEnabled = true;
+	}
+
+	Settings->bSyncPlanDirty = true;
+}
+
+void FOmniSyncSandbox::SaveSettings()
+{
+	Settings->bSnapshotDirty = true;
+	Settings->SavePluginSettings();
+	WaitUntilIdle();
+}
+
+void FOmniSyncSandbox::LoadSettings()
+{
+	Settings->LoadPluginSettings();
+	Settings->RebuildSettingsIndex();
+}
+
+void FOmniSyncSandbox::Push()
+{
+	Settings->SaveSettingsToGlobal();
+	WaitUntilIdle();
+}
+
+void FOmniSyncSandbox::Pull()
+{
+	Settings->LoadSettingsFromGlobal();
+	WaitUntilIdle();
+}
+
+void FOmniSyncSandbox::Tick()
+{
+	// Only queues the sweep, the game thread cost of a tick is what is left
+	Settings->AutoSyncTick( 0.0f );
+}
+
+void FOmniSyncSandbox::WaitUntilIdle()
+{
+	Settings->GetWorker().WaitUntilIdle();
+
+	// Completion callbacks only run once the game thread is free again, a finished sweep is forgotten here so the next tick queues another
+	Settings->AutoSyncJobId = 0;
+}
+
+TArray< FOmniSyncBenchmarkResult > FOmniSyncBenchmark::Run( const TArray< int32 >& Sizes, const int32 Iterations )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FOmniSyncBenchmarkResult > Results;
+	for( const int32 NumFiles: Sizes )
+		RunSize( NumFiles, Iterations, Results );
+
+	for( const FOmniSyncBenchmarkResult& Result: Results )
+	{
+		UE_LOG( OmniSync,
+		        Display,
+		        TEXT( "%6d files  %-36s median %9.3f ms  max %9.3f ms  memory %+lld KiB" ),
+		        Result.NumFiles,
+		        *Result.Operation,
+		        GetMedian( Result.SamplesMs ),
+		        Result.SamplesMs.IsEmpty() ? 0.0 : FMath::Max( Result.SamplesMs ),
+		        GetMedian( Result.MemorySamplesBytes ) / 1024 );
+	}
+
+	return Results;
+}
+
+bool FOmniSyncBenchmark::WriteJson( const TArray< FOmniSyncBenchmarkResult >& Results, const int32 Iterations, const FString& File )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< TSharedPtr< FJsonValue > > ResultValues;
+	for( const FOmniSyncBenchmarkResult& Result: Results )
+	{
+		TArray< TSharedPtr< FJsonValue > > SampleValues;
+		for( const double Sample: Result.SamplesMs )
+			SampleValues.Add( MakeShared< FJsonValueNumber >( Sample ) );
+
+		TArray< TSharedPtr< FJsonValue > > MemoryValues;
+		for( const int64 Sample: Result.MemorySamplesBytes )
+			MemoryValues.Add( MakeShared< FJsonValueNumber >( static_cast< double >( Sample ) ) );
+
+		const TSharedRef< FJsonObject > ResultObject = MakeShared< FJsonObject >();
+		ResultObject->SetStringField( TEXT( "Operation" ), Result.Operation );
+		ResultObject->SetNumberField( TEXT( "Files" ), Result.NumFiles );
+		ResultObject->SetNumberField( TEXT( "MinMs" ), Result.SamplesMs.IsEmpty() ? 0.0 : FMath::Min( Result.SamplesMs ) );
+		ResultObject->SetNumberField( TEXT( "MedianMs" ), GetMedian( Result.SamplesMs ) );
+		ResultObject->SetNumberField( TEXT( "MaxMs" ), Result.SamplesMs.IsEmpty() ? 0.0 : FMath::Max( Result.SamplesMs ) );
+		ResultObject->SetNumberField( TEXT( "MedianMemoryDeltaBytes" ), static_cast< double >( GetMedian( Result.MemorySamplesBytes ) ) );
+		ResultObject->SetArrayField( TEXT( "SamplesMs" ), SampleValues );
+		ResultObject->SetArrayField( TEXT( "MemoryDeltaSamplesBytes" ), MemoryValues );
+		ResultValues.Add( MakeShared< FJsonValueObject >( ResultObject ) );
+	}
+
+	const TSharedRef< FJsonObject > RootObject = MakeShared< FJsonObject >();
+	RootObject->SetStringField( TEXT( "Engine" ), FString::Printf( TEXT( "%d.%d" ), ENGINE_MAJOR_VERSION, ENGINE_MINOR_VERSION ) );
+	RootObject->SetStringField( TEXT( "Platform" ), FPlatformProperties::IniPlatformName() );
+	RootObject->SetNumberField( TEXT( "Iterations" ), Iterations );
+	RootObject->SetArrayField( TEXT( "Results" ), ResultValues );
+
+	FString                           OutputString;
+	const TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create( &OutputString );
+	if( !FJsonSerializer::Serialize( RootObject, Writer ) || !FFileHelper::SaveStringToFile( OutputString, *File ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to write benchmark results to %s" ), *File );
+		return false;
+	}
+
+	return true;
+}
+
+bool FOmniSyncBenchmark::FindRegressions( const TArray< FOmniSyncBenchmarkResult >& Results,
+                                          const FString&                            BaselineFile,
+                                          const double                              Tolerance,
+                                          TArray< FOmniSyncBenchmarkRegression >&   OutRegressions )
+{
+	TRACE_CPU_SCOPE;
+
+	FString JsonString;
+	if( !FFileHelper::LoadFileToString( JsonString, *BaselineFile, FFileHelper::EHashOptions::None, FILEREAD_Silent ) )
+		return false;
+
+	TSharedPtr< FJsonObject >         RootObject;
+	const TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create( JsonString );
+
+	const TArray< TSharedPtr< FJsonValue > >* ResultValues = nullptr;
+	if( !FJsonSerializer::Deserialize( Reader, RootObject ) || !RootObject.IsValid() || !RootObject->TryGetArrayField( TEXT( "Results" ), ResultValues ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Ignoring unreadable benchmark baseline %s" ), *BaselineFile );
+		return false;
+	}
+
+	TMap< FString, double > BaselineMedians;
+	for( const TSharedPtr< FJsonValue >& ResultValue: *ResultValues )
+	{
+		const TSharedPtr< FJsonObject >* ResultObject = nullptr;
+		if( ResultValue.IsValid() && ResultValue->TryGetObject( ResultObject ) )
+			BaselineMedians.Add( GetResultKey( ( *ResultObject )->GetStringField( TEXT( "Operation" ) ), ( *ResultObject )->GetIntegerField( TEXT( "Files" ) ) ),
+			                     ( *ResultObject )->GetNumberField( TEXT( "MedianMs" ) ) );
+	}
+
+	for( const FOmniSyncBenchmarkResult& Result: Results )
+	{
+		const double* BaselineMedianMs = BaselineMedians.Find( GetResultKey( Result.Operation, Result.NumFiles ) );
+		const double  MedianMs         = GetMedian( Result.SamplesMs );
+		if( BaselineMedianMs && MedianMs > *BaselineMedianMs * Tolerance && MedianMs - *BaselineMedianMs > RegressionFloorMs )
+			OutRegressions.Add( { Result.Operation, Result.NumFiles, *BaselineMedianMs, MedianMs } );
+	}
+
+	return true;
+}
+
+FString FOmniSyncBenchmark::GetDefaultBaselineFile()
+{
+	// CI keeps its baseline with the build machine, locally it sits outside the per-size folders, which every run deletes again
+	FString BaselineFile;
+	if( FParse::Value( FCommandLine::Get(), TEXT( "OmniSyncBenchmarkBaseline=" ), BaselineFile ) && !BaselineFile.IsEmpty() )
+		return BaselineFile;
+
+	return FPaths::Combine( FPaths::ProjectSavedDir(), TEXT( "OmniSyncBenchmark" ), TEXT( "Baseline.json" ) );
+}
+
+void FOmniSyncBenchmark::RunSize( const int32 NumFiles, const int32 Iterations, TArray< FOmniSyncBenchmarkResult >& OutResults )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncSandbox Sandbox( NumFiles );
+
+	auto MakeResult = [NumFiles]( const TCHAR* Operation )
+	{
+		FOmniSyncBenchmarkResult Result;
+		Result.Operation = Operation;
+		Result.NumFiles  = NumFiles;
+		return Result;
+	};
+
+	FOmniSyncBenchmarkResult ColdDiscovery = MakeResult( TEXT( "DiscoverAndAddConfigFiles.Cold" ) );
+	FOmniSyncBenchmarkResult WarmDiscovery = MakeResult( TEXT( "DiscoverAndAddConfigFiles" ) );
+
+	Measure( ColdDiscovery, [&] { Sandbox.Discover(); Sandbox.WaitUntilIdle(); } );
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+		Measure( WarmDiscovery, [&] { Sandbox.Discover(); } );
+
+	OutResults.Add( MoveTemp( ColdDiscovery ) );
+	OutResults.Add( MoveTemp( WarmDiscovery ) );
+
+	Sandbox.EnableAll();
+
+	FOmniSyncBenchmarkResult SaveSettings = MakeResult( TEXT( "SavePluginSettings" ) );
+	FOmniSyncBenchmarkResult LoadSettings = MakeResult( TEXT( "LoadPluginSettings" ) );
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		Measure( SaveSettings, [&] { Sandbox.SaveSettings(); } );
+		Measure( LoadSettings, [&] { Sandbox.LoadSettings(); } );
+	}
+
+	OutResults.Add( MoveTemp( SaveSettings ) );
+	OutResults.Add( MoveTemp( LoadSettings ) );
+
+	FOmniSyncBenchmarkResult Push      = MakeResult( TEXT( "SaveSettingsToGlobal" ) );
+	FOmniSyncBenchmarkResult Pull      = MakeResult( TEXT( "LoadSettingsFromGlobal" ) );
+	FOmniSyncBenchmarkResult TickCost  = MakeResult( TEXT( "AutoSyncTick" ) );
+	FOmniSyncBenchmarkResult TickSweep = MakeResult( TEXT( "AutoSyncTick.Sweep" ) );
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		Measure( Push, [&] { Sandbox.Push(); } );
+		Measure( Pull, [&] { Sandbox.Pull(); } );
+
+		// The tick itself only queues the sweep, the game thread cost and the sweep on the worker are reported apart
+		Measure( TickCost, [&] { Sandbox.Tick(); } );
+		Measure( TickSweep, [&] { Sandbox.WaitUntilIdle(); } );
+	}
+
+	OutResults.Add( MoveTemp( Push ) );
+	OutResults.Add( MoveTemp( Pull ) );
+	OutResults.Add( MoveTemp( TickCost ) );
+	OutResults.Add( MoveTemp( TickSweep ) );
+
+	if( FSlateApplication::IsInitialized() )
+	{
+		FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked< FPropertyEditorModule >( "PropertyEditor" );
+
+		FDetailsViewArgs DetailsViewArgs;
+		DetailsViewArgs.bAllowSearch     = false;
+		DetailsViewArgs.NameAreaSettings = FDetailsViewArgs::HideNameArea;
+
+		// Setting the object runs the registered customization, whose RefreshTreeData dominates building the panel
+		const TSharedRef< IDetailsView > DetailsView = PropertyModule.CreateDetailView( DetailsViewArgs );
+		FOmniSyncBenchmarkResult         RefreshTree = MakeResult( TEXT( "RefreshTreeData" ) );
+		for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+			Measure( RefreshTree, [&] { DetailsView->SetObject( &Sandbox.GetSettings(), true ); } );
+
+		DetailsView->SetObject( nullptr );
+		OutResults.Add( MoveTemp( RefreshTree ) );
+	}
+}
+
+void FOmniSyncBenchmark::Measure( FOmniSyncBenchmarkResult& Result, const TFunctionRef< void() > Operation )
+{
+	// The engine allocator only counts allocations under memory tracing, each sample records the used memory delta instead
+	const uint64 UsedBefore = FPlatformMemory::GetStats().UsedPhysical;
+	const double StartTime  = FPlatformTime::Seconds();
+
+	Operation();
+
+	Result.SamplesMs.Add( ( FPlatformTime::Seconds() - StartTime ) * 1000.0 );
+	Result.MemorySamplesBytes.Add( static_cast< int64 >( FPlatformMemory::GetStats().UsedPhysical ) - static_cast< int64 >( UsedBefore ) );
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "FOmniSyncBlobStorage.h"
+
+#include "FOmniSync.h"
+#include "FOmniSyncManifest.h"
+#include "JsonObjectConverter.h"
+#include "Macros.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 BlobMagic       = 0x3142534F; // "OSB1"
+	constexpr uint8  BlobCompressed  = 1 << 0;
+	constexpr int32  BlobHeaderBytes = sizeof( uint32 ) + sizeof( uint8 ) + sizeof( int32 );
+
+	constexpr const TCHAR* BlobManifestName = TEXT( "OmniSyncBlobManifest.json" );
+
+	// Pushes save their manifests at the end of the batch, a blob written or reused this recently may still be about to be referenced
+	constexpr double BlobGraceSeconds = 60.0 * 60.0;
+
+	void CollectBlobs( const TArray< FString >& )
+	{
+		UOmniSyncSettings::Get()->CollectBlobs();
+	}
+
+	FAutoConsoleCommand CollectBlobsCommand( TEXT( "OmniSync.CollectBlobs" ),
+	                                         TEXT( "Deletes blobs that no project or engine version references any more" ),
+	                                         FConsoleCommandWithArgsDelegate::CreateStatic( &CollectBlobs ) );
+}
+
+bool FOmniSyncBlobStorage::GetHash( const EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncManifest& Manifest = GetManifest( Scope );
+	Manifest.Refresh();
+
+	const FOmniSyncManifestEntry* Entry = Manifest.Find( RelativePath );
+	if( !Entry || Entry->Hash.IsEmpty() )
+		return false;
+
+	OutHash = FOmniSyncManifest::StringToHash( Entry->Hash );
+
+	// An entry whose blob went missing is treated like a missing file so the next push restores it
+	return IFileManager::Get().FileExists( *GetBlobPath( OutHash ) );
+}
+
+bool FOmniSyncBlobStorage::Read( const EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes )
+{
+	TRACE_CPU_SCOPE;
+
+	const FOmniSyncManifestEntry* Entry = GetManifest( Scope ).Find( RelativePath );
+	if( !Entry )
+		return false;
+
+	const FString   BlobPath = GetBlobPath( FOmniSyncManifest::StringToHash( Entry->Hash ) );
+	TArray< uint8 > Blob;
+	if( !FFileHelper::LoadFileToArray( Blob, *BlobPath ) || !DecodeBlob( Blob, OutBytes ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to read blob %s for %s" ), *BlobPath, *RelativePath );
+		return false;
+	}
+
+	return true;
+}
+
+bool FOmniSyncBlobStorage::Write( const EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, const uint64 Hash )
+{
+	TRACE_CPU_SCOPE;
+
+	// Content that any scope or project already pushed is stored once, only the manifest entry is new
+	const FString BlobPath = GetBlobPath( Hash );
+	if( !IFileManager::Get().FileExists( *BlobPath ) )
+	{
+		TArray< uint8 > Blob;
+		EncodeBlob( Bytes, bCompress, Blob );
+
+		// Written under a name of its own first, so a reader never sees half a blob and two editors pushing the same content never share a file
+		const FString TempPath = FString::Printf( TEXT( "%s.%s.tmp" ), *BlobPath, *FGuid::NewGuid().ToString() );
+		if( !FFileHelper::SaveArrayToFile( Blob, *TempPath ) || !IFileManager::Get().Move( *BlobPath, *TempPath ) )
+		{
+			IFileManager::Get().Delete( *TempPath );
+			return false;
+		}
+	}
+	else
+	{
+		// A reused blob may have been unreferenced until now, touching it keeps garbage collection away until the manifest is saved
+		IFileManager::Get().SetTimeStamp( *BlobPath, FDateTime::UtcNow() );
+	}
+
+	FOmniSyncManifest&            Manifest = GetManifest( Scope );
+	const FString                 HashText = FOmniSyncManifest::HashToString( Hash );
+	const FOmniSyncManifestEntry* Existing = Manifest.Find( RelativePath );
+	if( Existing && Existing->Hash == HashText )
+		return true;
+
+	FOmniSyncManifestEntry Entry;
+	Entry.Size      = Bytes.Num();
+	Entry.Timestamp = FDateTime::UtcNow();
+	Entry.Hash      = HashText;
+	Manifest.Set( RelativePath, Entry );
+	return true;
+}
+
+bool FOmniSyncBlobStorage::Flush()
+{
+	TRACE_CPU_SCOPE;
+
+	// A blob nobody's manifest points at was never pushed as far as other editors can tell. Entries that could not be saved are
+	// dropped like a lost pack write, a later save would publish them without a generation bump
+	bool bSaved = true;
+	for( const TPair< EOmniSyncScope, TSharedPtr< FOmniSyncManifest > >& Pair: Manifests )
+	{
+		if( Pair.Value->Save() )
+			continue;
+
+		Pair.Value->Load();
+		bSaved = false;
+	}
+
+	return bSaved;
+}
+
+TArray< FString > FOmniSyncBlobStorage::GetRelativePaths( const EOmniSyncScope Scope )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncManifest& Manifest = GetManifest( Scope );
+	Manifest.Refresh();
+
+	TArray< FString > RelativePaths;
+	Manifest.GetEntries().GetKeys( RelativePaths );
+	return RelativePaths;
+}
+
+FString FOmniSyncBlobStorage::GetBlobsDirectory()
+{
+	if( UOmniSyncSettings::IsStoreRootScoped() )
+		return FPaths::Combine( UOmniSyncSettings::GetStoreRootDirectory(), "Blobs" );
+
+	static const FString BlobsDir = FPaths::Combine( UOmniSyncSettings::GetStoreRootDirectory(), "Blobs" );
+	return BlobsDir;
+}
+
+FString FOmniSyncBlobStorage::GetBlobPath( const uint64 Hash )
+{
+	const FString HashText = FOmniSyncManifest::HashToString( Hash );
+	return FPaths::Combine( GetBlobsDirectory(), HashText.Left( 2 ), HashText + TEXT( ".blob" ) );
+}
+
+int32 FOmniSyncBlobStorage::CollectGarbage()
+{
+	TRACE_CPU_SCOPE;
+
+	// Blobs are shared by every scope of every engine version and project, so every blob manifest under the store root is marked
+	TArray< FString > ManifestFiles;
+	IFileManager::Get().FindFilesRecursive( ManifestFiles, *UOmniSyncSettings::GetStoreRootDirectory(), BlobManifestName, true, false );
+
+	TSet< FString > Referenced;
+	for( const FString& ManifestFile: ManifestFiles )
+	{
+		FString               JsonString;
+		FOmniSyncManifestData Data;
+		if( !FFileHelper::LoadFileToString( JsonString, *ManifestFile ) || !FJsonObjectConverter::JsonObjectStringToUStruct( JsonString, &Data ) )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Not collecting blobs, %s is unreadable" ), *ManifestFile );
+			return INDEX_NONE;
+		}
+
+		for( const TPair< FString, FOmniSyncManifestEntry >& Entry: Data.Entries )
+			Referenced.Add( Entry.Value.Hash );
+	}
+
+	TArray< FString > BlobFiles;
+	IFileManager::Get().FindFilesRecursive( BlobFiles, *GetBlobsDirectory(), TEXT( "*" ), true, false );
+
+	// Leftover temporary files of crashed writers go the same way once they are old enough
+	int32           Deleted = 0;
+	const FDateTime Now     = FDateTime::UtcNow();
+	for( const FString& BlobFile: BlobFiles )
+	{
+		if( ( Now - IFileManager::Get().GetTimeStamp( *BlobFile ) ).GetTotalSeconds() < BlobGraceSeconds )
+			continue;
+
+		if( BlobFile.EndsWith( TEXT( ".blob" ) ) && Referenced.Contains( FPaths::GetBaseFilename( BlobFile ) ) )
+			continue;
+
+		if( IFileManager::Get().Delete( *BlobFile, false, false, true ) )
+			Deleted++;
+	}
+
+	UE_LOG( OmniSync, Log, TEXT( "Collected %d of %d blobs, %d manifests reference the rest" ), Deleted, BlobFiles.Num(), ManifestFiles.Num() );
+	return Deleted;
+}
+
+void FOmniSyncBlobStorage::EncodeBlob( const TArray< uint8 >& Bytes, const bool bCompressPayload, TArray< uint8 >& OutBlob )
+{
+	TRACE_CPU_SCOPE;
+
+	uint32 Magic   = BlobMagic;
+	uint8  Flags   = 0;
+	int32  RawSize = Bytes.Num();
+
+	TArray< uint8 > Compressed;
+	if( bCompressPayload && RawSize > 0 )
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound( NAME_Zlib, RawSize );
+		Compressed.SetNumUninitialized( CompressedSize );
+
+		// Tiny files can grow under compression, those are kept raw
+		if( FCompression::CompressMemory( NAME_Zlib, Compressed.GetData(), CompressedSize, Bytes.GetData(), RawSize ) && CompressedSize < RawSize )
+		{
+			Compressed.SetNum( CompressedSize );
+			Flags |= BlobCompressed;
+		}
+	}
+
+	const TArray< uint8 >& Payload = Flags & BlobCompressed ? Compressed : Bytes;
+
+	OutBlob.Reset( BlobHeaderBytes + Payload.Num() );
+	FMemoryWriter Writer( OutBlob );
+	Writer << Magic << Flags << RawSize;
+	Writer.Serialize( const_cast< uint8* >( Payload.GetData() ), Payload.Num() );
+}
+
+bool FOmniSyncBlobStorage::DecodeBlob( const TArray< uint8 >& Blob, TArray< uint8 >& OutBytes )
+{
+	TRACE_CPU_SCOPE;
+
+	if( Blob.Num() < BlobHeaderBytes )
+		return false;
+
+	uint32 Magic   = 0;
+	uint8  Flags   = 0;
+	int32  RawSize = 0;
+
+	FMemoryReader Reader( Blob );
+	Reader << Magic << Flags << RawSize;
+	if( Magic != BlobMagic || RawSize < 0 )
+		return false;
+
+	const uint8* Payload     = Blob.GetData() + BlobHeaderBytes;
+	const int32  PayloadSize = Blob.Num() - BlobHeaderBytes;
+
+	OutBytes.SetNumUninitialized( RawSize );
+	if( Flags & BlobCompressed )
+		return FCompression::UncompressMemory( NAME_Zlib, OutBytes.GetData(), RawSize, Payload, PayloadSize );
+
+	if( PayloadSize != RawSize )
+		return false;
+
+	FMemory::Memcpy( OutBytes.GetData(), Payload, RawSize );
+	return true;
+}
+
+FOmniSyncManifest& FOmniSyncBlobStorage::GetManifest( const EOmniSyncScope Scope )
+{
+	TSharedPtr< FOmniSyncManifest >& Manifest = Manifests.FindOrAdd( Scope );
+	if( !Manifest.IsValid() )
+	{
+		Manifest = MakeShared< FOmniSyncManifest >( FPaths::Combine( UOmniSyncSettings::GetScopedSettingsDirectory( Scope ), BlobManifestName ) );
+		Manifest->Load();
+	}
+
+	return *Manifest;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "FOmniSyncBundle.h"
+
+#include "FOmniSync.h"
+#include "FOmniSyncManifest.h"
+#include "IOmniSyncStorage.h"
+#include "Macros.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 BundleMagic   = 0x4442534F; // "OSBD"
+	constexpr uint32 BundleVersion = 2;
+
+	void ExportBundle( const TArray< FString >& Args )
+	{
+		if( Args.IsEmpty() )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Usage: OmniSync.ExportBundle <File>" ) );
+			return;
+		}
+
+		UOmniSyncSettings::Get()->ExportBundle( Args[ 0 ] );
+	}
+
+	void ImportBundle( const TArray< FString >& Args )
+	{
+		if( Args.IsEmpty() )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Usage: OmniSync.ImportBundle <File>" ) );
+			return;
+		}
+
+		UOmniSyncSettings::Get()->ImportBundle( Args[ 0 ] );
+	}
+
+	FAutoConsoleCommand ExportBundleCommand( TEXT( "OmniSync.ExportBundle" ),
+	                                         TEXT( "Writes every stored file of all scopes, engine versions and projects into one bundle file. Usage: OmniSync.ExportBundle <File>" ),
+	                                         FConsoleCommandWithArgsDelegate::CreateStatic( &ExportBundle ) );
+
+	FAutoConsoleCommand ImportBundleCommand( TEXT( "OmniSync.ImportBundle" ),
+	                                         TEXT( "Writes the files of a bundle back into the scope, engine version and project directories they were exported from. Bundles "
+		                                         "of the first format only name the scope and go into this editor's directories. Usage: OmniSync.ImportBundle <File>" ),
+	                                         FConsoleCommandWithArgsDelegate::CreateStatic( &ImportBundle ) );
+}
+
+bool FOmniSyncBundle::Export( const FVisitDirectory VisitDirectory, const FString& File, int32* OutFileCount )
+{
+	TRACE_CPU_SCOPE;
+
+	uint32 Magic   = BundleMagic;
+	uint32 Version = BundleVersion;
+	int32  Count   = 0;
+
+	TArray64< uint8 > Buffer;
+	FMemoryWriter64   Writer( Buffer );
+	Writer << Magic << Version << Count;
+
+	for( const EOmniSyncScope Scope: { EOmniSyncScope::Global, EOmniSyncScope::PerEngineVersion, EOmniSyncScope::PerProject } )
+	{
+		for( const FString& Directory: FindScopeDirectories( Scope ) )
+		{
+			// Recorded as the engine version or project name, the importing machine resolves it below its own store root
+			FString DirectoryName = Scope == EOmniSyncScope::Global ? FString() : FPaths::GetCleanFilename( Directory );
+
+			VisitDirectory( Scope, Directory, [&]( IOmniSyncStorage& Storage )
+			{
+				for( FString& RelativePath: Storage.GetRelativePaths( Scope ) )
+				{
+					TArray< uint8 > Bytes;
+					if( !Storage.Read( Scope, RelativePath, Bytes ) )
+					{
+						UE_LOG( OmniSync, Warning, TEXT( "Skipping unreadable %s in bundle" ), *FPaths::Combine( Directory, RelativePath ) );
+						continue;
+					}
+
+					uint8  ScopeValue = static_cast< uint8 >( Scope );
+					uint64 Hash       = FOmniSyncManifest::HashBuffer( Bytes.GetData(), Bytes.Num() );
+					Writer << ScopeValue << DirectoryName << RelativePath << Hash << Bytes;
+					Count++;
+				}
+			} );
+		}
+	}
+
+	Writer.Seek( 0 );
+	Writer << Magic << Version << Count;
+
+	if( !FFileHelper::SaveArrayToFile( Buffer, *File ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to write bundle: %s" ), *File );
+		return false;
+	}
+
+	UE_LOG( OmniSync, Log, TEXT( "Exported %d files to bundle: %s" ), Count, *File );
+
+	if( OutFileCount )
+		*OutFileCount = Count;
+
+	return true;
+}
+
+bool FOmniSyncBundle::Import( const FString& File, const FWriteFile WriteFile, int32* OutFileCount )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray64< uint8 > Buffer;
+	if( !FFileHelper::LoadFileToArray( Buffer, *File ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to read bundle: %s" ), *File );
+		return false;
+	}
+
+	FMemoryReader64 Reader( Buffer );
+
+	uint32 Magic   = 0;
+	uint32 Version = 0;
+	int32  Count   = 0;
+	Reader << Magic << Version << Count;
+
+	if( Reader.IsError() || Magic != BundleMagic || Version < 1 || Version > BundleVersion || Count < 0 )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Not an OmniSync bundle: %s" ), *File );
+		return false;
+	}
+
+	int32 Imported = 0;
+	for( int32 Index = 0; Index < Count; ++Index )
+	{
+		uint8           ScopeValue = 0;
+		FString         DirectoryName;
+		FString         RelativePath;
+		uint64          Hash = 0;
+		TArray< uint8 > Bytes;
+		Reader << ScopeValue;
+		if( Version >= 2 )
+			Reader << DirectoryName;
+		Reader << RelativePath << Hash << Bytes;
+
+		if( Reader.IsError() || ScopeValue > static_cast< uint8 >( EOmniSyncScope::PerProject ) )
+		{
+			UE_LOG( OmniSync, Error, TEXT( "Bundle is truncated: %s" ), *File );
+			break;
+		}
+
+		const EOmniSyncScope Scope            = static_cast< EOmniSyncScope >( ScopeValue );
+		const FString        CurrentDirectory = UOmniSyncSettings::GetScopedSettingsDirectory( Scope );
+		if( Scope != EOmniSyncScope::Global && !DirectoryName.IsEmpty() && !IsSafeDirectoryName( DirectoryName ) )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Skipping %s in bundle, %s is not a directory name" ), *RelativePath, *DirectoryName );
+			continue;
+		}
+
+		if( !IsSafeRelativePath( RelativePath ) )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Skipping %s in bundle, it is not a relative .ini path" ), *RelativePath );
+			continue;
+		}
+
+		if( FOmniSyncManifest::HashBuffer( Bytes.GetData(), Bytes.Num() ) != Hash )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Skipping corrupt %s in bundle" ), *RelativePath );
+			continue;
+		}
+
+		const FString Directory = Scope == EOmniSyncScope::Global || DirectoryName.IsEmpty() ? CurrentDirectory : FPaths::Combine( FPaths::GetPath( CurrentDirectory ), DirectoryName );
+		if( WriteFile( Scope, Directory, RelativePath, Bytes, Hash ) )
+			Imported++;
+	}
+
+	UE_LOG( OmniSync, Log, TEXT( "Imported %d of %d files from bundle: %s" ), Imported, Count, *File );
+
+	if( OutFileCount )
+		*OutFileCount = Imported;
+
+	return Imported == Count;
+}
+
+TArray< FString > FOmniSyncBundle::FindScopeDirectories( const EOmniSyncScope Scope )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FString > Directories = { UOmniSyncSettings::GetScopedSettingsDirectory( Scope ) };
+	if( Scope == EOmniSyncScope::Global )
+		return Directories;
+
+	// PerEngineVersion/<Version> and PerProject/<Project> sit next to the directories of the other engine versions and projects
+	const FString     Parent = FPaths::GetPath( Directories[ 0 ] );
+	TArray< FString > Names;
+	IFileManager::Get().FindFiles( Names, *FPaths::Combine( Parent, TEXT( "*" ) ), false, true );
+	Names.Sort();
+
+	for( const FString& Name: Names )
+	{
+		FString Directory = FPaths::Combine( Parent, Name );
+		if( !FPaths::IsSamePath( Directory, Directories[ 0 ] ) )
+			Directories.Add( MoveTemp( Directory ) );
+	}
+
+	return Directories;
+}
+
+bool FOmniSyncBundle::IsSafeRelativePath( const FString& RelativePath )
+{
+	const FString Path = RelativePath.Replace( TEXT( "\\" ), TEXT( "/" ) );
+	if( Path.IsEmpty() || !FPaths::IsRelative( Path ) || Path.StartsWith( TEXT( "/" ) ) || Path.Contains( TEXT( ":" ) ) || !Path.EndsWith( TEXT( ".ini" ) ) )
+		return false;
+
+	TArray< FString > Segments;
+	Path.ParseIntoArray( Segments, TEXT( "/" ) );
+	return !Segments.ContainsByPredicate( []( const FString& Segment ) { return Segment == TEXT( ".." ) || Segment == TEXT( "." ); } );
+}
+
+bool FOmniSyncBundle::IsSafeDirectoryName( const FString& Name )
+{
+	return !Name.IsEmpty() && Name != TEXT( "." ) && Name != TEXT( ".." ) && !Name.Contains( TEXT( "/" ) ) && !Name.Contains( TEXT( "\\" ) ) && !Name.Contains( TEXT( ":" ) );
+}
\ No newline at end of file
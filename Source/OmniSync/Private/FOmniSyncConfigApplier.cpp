@@ -0,0 +1,150 @@
+#include "FOmniSyncConfigApplier.h"
+
+#include "FOmniSync.h"
+#include "Macros.h"
+#include "Misc/ConfigCacheIni.h"
+#include "UObject/UObjectIterator.h"
+#include "UOmniSyncSettings.h"
+
+int32 FOmniSyncConfigApplier::Apply( const TArray< FOmniSyncPulledFile >& PulledFiles )
+{
+	TRACE_CPU_SCOPE;
+	check( IsInGameThread() );
+
+	if( !GConfig )
+		return 0;
+
+	// The pulled files are already on disk, so the hierarchy read back from there holds every key as a fresh editor would see it
+	TMap< FString, TUniquePtr< FConfigFile > > BranchLayers;
+
+	int32 AppliedKeys = 0;
+	for( const FOmniSyncPulledFile& PulledFile: PulledFiles )
+	{
+		const FString BranchName = GetBranchName( PulledFile.RelativePath );
+		if( BranchName.IsEmpty() )
+			continue;
+
+		// The hierarchy read back below would hold nothing or the old value for keys of a layer it does not contain
+		if( !IsInReloadedHierarchy( PulledFile.RelativePath ) )
+		{
+			UE_LOG( OmniSync, Log, TEXT( "Not hot-applying %s, its layer is not part of the reloaded %s hierarchy" ), *PulledFile.RelativePath, *BranchName );
+			continue;
+		}
+
+		// Branches that were never loaded pick the new file up on first access, there is nothing in memory to patch
+		const FString Filename = GConfig->GetConfigFilename( *BranchName );
+		if( Filename.IsEmpty() || !GConfig->FindConfigFile( Filename ) )
+			continue;
+
+		TUniquePtr< FConfigFile >& Layers = BranchLayers.FindOrAdd( BranchName );
+		if( !Layers.IsValid() )
+		{
+			Layers = MakeUnique< FConfigFile >();
+			FConfigCacheIni::LoadLocalIniFile( *Layers, *BranchName, true, nullptr, true );
+		}
+
+		TSet< FString > ChangedSections;
+		for( const FOmniSyncIniChange& Change: PulledFile.Changes )
+		{
+			if( !ApplyKey( Filename, *Layers, PulledFile, Change ) )
+				continue;
+
+			ChangedSections.Add( Change.Section );
+			AppliedKeys++;
+		}
+
+		if( !ChangedSections.IsEmpty() )
+			ReloadClasses( FName( *BranchName ), ChangedSections );
+	}
+
+	if( AppliedKeys > 0 )
+		UE_LOG( OmniSync, Log, TEXT( "Hot-applied %d config keys" ), AppliedKeys );
+
+	return AppliedKeys;
+}
+
+FString FOmniSyncConfigApplier::GetBranchName( const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	FString       BaseName  = FPaths::GetBaseFilename( RelativePath );
+	const FString Directory = FPaths::GetCleanFilename( FPaths::GetPath( RelativePath ) );
+
+	if( BaseName.StartsWith( TEXT( "Default" ) ) )
+		return BaseName.RightChop( 7 );
+
+	// Config/<Platform>/<Platform><Branch>.ini only feeds the running editor when it is the editor's own platform
+	if( !Directory.IsEmpty() && BaseName.StartsWith( Directory ) && BaseName.Len() > Directory.Len() )
+	{
+		if( Directory != FString( FPlatformProperties::IniPlatformName() ) )
+			return FString();
+
+		return BaseName.RightChop( Directory.Len() );
+	}
+
+	return BaseName;
+}
+
+bool FOmniSyncConfigApplier::IsInReloadedHierarchy( const FString& RelativePath )
+{
+	// LoadLocalIniFile only re-reads the engine and project Config directories, plugin and Saved/Config layers are not part of it
+	const FString NormalizedPath = UOmniSyncSettings::NormalizeRelativePath( RelativePath );
+	return NormalizedPath.StartsWith( TEXT( "Config/" ) );
+}
+
+bool FOmniSyncConfigApplier::ApplyKey( const FString& Filename, const FConfigFile& Layers, const FOmniSyncPulledFile& PulledFile, const FOmniSyncIniChange& Change )
+{
+	const FString& Section = Change.Section;
+	const FString& Key     = Change.Key;
+
+	// Array operations of the pulled file are replayed on top of the layers below it instead of the branch in memory, which still
+	// holds the entries the file added before. A key the file no longer sets falls back to what those layers give it
+	TArray< FString > Values;
+	Layers.GetArray( *Section, *Key, Values );
+
+	TArray< FString > CurrentValues;
+	GConfig->GetArray( *Section, *Key, CurrentValues, Filename );
+
+	if( Values == CurrentValues )
+		return false;
+
+	if( Values.IsEmpty() )
+	{
+		// Only a key the pulled file dropped is removed, a key it still sets that the re-read lacks means the re-read missed the file
+		if( PulledFile.Document.FindLines( Section, Key ) )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Not hot-applying [%s] %s from %s, the reloaded hierarchy does not contain it" ), *Section, *Key, *PulledFile.RelativePath );
+			return false;
+		}
+
+		return GConfig->RemoveKey( *Section, *Key, Filename );
+	}
+
+	if( Values.Num() == 1 )
+		GConfig->SetString( *Section, *Key, *Values[ 0 ], Filename );
+	else
+		GConfig->SetArray( *Section, *Key, Values, Filename );
+
+	return true;
+}
+
+void FOmniSyncConfigApplier::ReloadClasses( const FName BranchName, const TSet< FString >& Sections )
+{
+	TRACE_CPU_SCOPE;
+
+	for( TObjectIterator< UClass > It; It; ++It )
+	{
+		UClass* Class = *It;
+		if( !Class->HasAnyClassFlags( CLASS_Config ) || Class->HasAnyClassFlags( CLASS_PerObjectConfig ) )
+			continue;
+
+		if( Class->ClassConfigName != BranchName || !Sections.Contains( Class->GetPathName() ) )
+			continue;
+
+		if( UObject* DefaultObject = Class->GetDefaultObject( false ) )
+		{
+			DefaultObject->ReloadConfig();
+			UE_LOG( OmniSync, Verbose, TEXT( "Reloaded config for %s" ), *Class->GetName() );
+		}
+	}
+}
\ No newline at end of file
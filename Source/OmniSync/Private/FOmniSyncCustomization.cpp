@@ -2,11 +2,93 @@
 
 #include "DetailLayoutBuilder.h"
 #include "DetailWidgetRow.h"
+#include "FOmniSyncHistory.h"
+#include "FOmniSyncStats.h"
+#include "Framework/MultiBox/MultiBoxBuilder.h"
+#include "Framework/Notifications/NotificationManager.h"
 #include "Macros.h"
 #include "UOmniSyncSettings.h"
+#include "Widgets/Input/SComboButton.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Notifications/SNotificationList.h"
 
 #define LOCTEXT_NAMESPACE "OmniSyncCustomization"
 
+namespace
+{
+	FOnSyncJobCompleted MakeSyncNotification( const FText& SucceededText, const FText& FailedText )
+	{
+		return FOnSyncJobCompleted::CreateLambda( [SucceededText, FailedText]( const bool bSucceeded )
+		{
+			FNotificationInfo Info( bSucceeded ? SucceededText : FailedText );
+			Info.ExpireDuration = 3.0f;
+			FSlateNotificationManager::Get().AddNotification( Info );
+		} );
+	}
+}
+
+void FConfigRowViewModel::Update( const FConfigFileSettings& Setting )
+{
+	bEnabled  = Setting.bEnabled;
+	bAutoSync = Setting.bAutoSyncEnabled;
+	bLayered  = Setting.bLayered;
+	Scope     = Setting.SettingsScope;
+
+	if( !bEnabled )
+	{
+		ScopeText = LOCTEXT( "Disabled", "Disabled" );
+	}
+	else
+	{
+		switch( Scope )
+		{
+			case EOmniSyncScope::Global:
+				ScopeText = LOCTEXT( "ScopeGlobal", "Global" );
+				break;
+			case EOmniSyncScope::PerEngineVersion:
+				ScopeText = LOCTEXT( "ScopePerEngineVersion", "Per Engine Version" );
+				break;
+			case EOmniSyncScope::PerProject:
+				ScopeText = LOCTEXT( "ScopePerProject", "Per Project" );
+				break;
+		}
+
+		if( bLayered && Scope != EOmniSyncScope::Global )
+			ScopeText = FText::Format( LOCTEXT( "ScopeLayered", "{0} (Layered)" ), ScopeText );
+	}
+
+	ScopeColor    = bEnabled ? FLinearColor( 0.7f, 0.7f, 1.0f ) : FLinearColor( 0.5f, 0.5f, 0.5f );
+	SyncModeText  = !bEnabled ? FText::GetEmpty() : bAutoSync ? LOCTEXT( "AutoSyncOn", "[Auto-Sync]" ) : LOCTEXT( "ManualSync", "[Manual]" );
+	SyncModeColor = bAutoSync ? FLinearColor( 0.3f, 1.0f, 0.3f ) : FLinearColor( 0.5f, 0.5f, 0.5f );
+}
+
+void FConfigRowViewModel::SetStatus( const EConfigRowStatus NewStatus )
+{
+	Status = NewStatus;
+
+	switch( Status )
+	{
+		case EConfigRowStatus::Synced:
+			StatusText  = LOCTEXT( "StatusSynced", "Synced" );
+			StatusColor = FLinearColor( 0.5f, 0.5f, 0.5f );
+			break;
+		case EConfigRowStatus::Failed:
+			StatusText  = LOCTEXT( "StatusFailed", "Sync failed" );
+			StatusColor = FLinearColor( 1.0f, 0.4f, 0.3f );
+			break;
+		default:
+			StatusText  = FText::GetEmpty();
+			StatusColor = FLinearColor::Transparent;
+			break;
+	}
+}
+
+FOmniSyncCustomization::~FOmniSyncCustomization()
+{
+	if( UOmniSyncSettings* Config = ConfigObject.Get() )
+		Config->OnFilesSynced().Remove( FilesSyncedHandle );
+}
+
 void FOmniSyncCustomization::CustomizeDetails( IDetailLayoutBuilder& DetailBuilder )
 {
 	TRACE_CPU_SCOPE;
@@ -17,6 +99,9 @@ void FOmniSyncCustomization::CustomizeDetails( IDetailLayoutBuilder& DetailBuild
 	if( !ObjectsBeingCustomized.IsEmpty() )
 		ConfigObject = Cast< UOmniSyncSettings >( ObjectsBeingCustomized[ 0 ].Get() );
 
+	if( UOmniSyncSettings* Config = ConfigObject.Get() )
+		FilesSyncedHandle = Config->OnFilesSynced().AddRaw( this, &FOmniSyncCustomization::OnFilesSynced );
+
 	TSharedRef< IPropertyHandle > StructHandle    = DetailBuilder.GetProperty( GET_MEMBER_NAME_CHECKED( UOmniSyncSettings, ConfigFileSettingsStruct ) );
 	IDetailCategoryBuilder&       ActionsCategory = DetailBuilder.EditCategory( "Actions", FText::FromString( "Actions" ), ECategoryPriority::Important );
 
@@ -52,7 +137,10 @@ void FOmniSyncCustomization::CustomizeDetails( IDetailLayoutBuilder& DetailBuild
 			.OnClicked_Lambda( [this]
 			{
 				if( UOmniSyncSettings* Config = ConfigObject.Get() )
-					Config->SaveSettingsToGlobal();
+				{
+					Config->SaveSettingsToGlobal( MakeSyncNotification( LOCTEXT( "SaveToGlobalSucceeded", "Config files saved to global" ),
+					                                                    LOCTEXT( "SaveToGlobalFailed", "Some config files could not be saved, see the output log" ) ) );
+				}
 				return FReply::Handled();
 			} )
 		]
@@ -63,131 +151,483 @@ void FOmniSyncCustomization::CustomizeDetails( IDetailLayoutBuilder& DetailBuild
 		[
 			SNew( SButton )
 			.Text( LOCTEXT( "LoadFromGlobal", "Load from Global" ) )
-			.ToolTipText( LOCTEXT( "LoadFromGlobalTooltip", "Load config files from their global sync locations. Restart may be required." ) )
+			.ToolTipText( LOCTEXT( "LoadFromGlobalTooltip", "Load config files from their global sync locations. Changed keys are applied to the running editor when hot-apply is enabled." ) )
 			.OnClicked_Lambda( [this]
 			{
 				if( UOmniSyncSettings* Config = ConfigObject.Get() )
-					Config->LoadSettingsFromGlobal();
+				{
+					Config->LoadSettingsFromGlobal( MakeSyncNotification( LOCTEXT( "LoadFromGlobalSucceeded", "Config files loaded from global" ),
+					                                                      LOCTEXT( "LoadFromGlobalFailed", "Some config files could not be loaded, see the output log" ) ) );
+				}
 				return FReply::Handled();
 			} )
 		]
 	];
 
+	ActionsCategory.AddCustomRow( LOCTEXT( "SyncStatusRow", "Sync Status" ) ).WholeRowContent()
+	[
+		SNew( STextBlock )
+		.Font( IDetailLayoutBuilder::GetDetailFont() )
+		.ColorAndOpacity( FSlateColor::UseSubduedForeground() )
+		.ToolTipText( LOCTEXT( "SyncStatusTooltip", "Counters since the editor started. Run OmniSync.Stats in the console for the full latency histograms, or add the omnisync channel to -trace for per-file spans in Unreal Insights." ) )
+		.Text_Static( &FOmniSyncStats::GetStatusText )
+	];
+
 	DetailBuilder.HideProperty( StructHandle );
 
+	IDetailCategoryBuilder& OptionsCategory = DetailBuilder.EditCategory( "Options", LOCTEXT( "Options", "Options" ), ECategoryPriority::Important );
+
+	const TPair< FName, FText > Options[] = {
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, bHotApplyOnLoad ),
+		  LOCTEXT( "HotApplyTooltip", "Apply pulled keys to the running editor and reload the affected settings classes" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, bAutoPull ),
+		  LOCTEXT( "AutoPullTooltip", "Pull auto-synced files as soon as another editor pushes a newer version of them to the store" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, SyncQuietWindowSeconds ),
+		  LOCTEXT( "QuietWindowTooltip", "How long a file has to stay unchanged before its changes are synced" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, SyncMaxDelaySeconds ),
+		  LOCTEXT( "MaxDelayTooltip", "Longest time a file that keeps changing waits before it is synced anyway" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, StorageMode ),
+		  LOCTEXT( "StorageModeTooltip", "Files keeps a plain copy per scope, ContentAddressed stores each distinct file content once and points the scopes at it, Packed keeps one archive per scope" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, bCompressBlobs ),
+		  LOCTEXT( "CompressBlobsTooltip", "Compress new blobs written in ContentAddressed mode" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, ExcludePaths ),
+		  LOCTEXT( "ExcludePathsTooltip", "Project relative globs (*, ?, **) of files and folders that are neither discovered nor synced, a pattern without a slash matches a name at any depth. Run discovery again to drop them from the list" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, IncludePaths ),
+		  LOCTEXT( "IncludePathsTooltip", "Globs that bring files back from excluded folders, for example Plugins/ThirdParty/Keep/**" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, HistoryMaxVersions ),
+		  LOCTEXT( "HistoryMaxVersionsTooltip", "How many versions of each stored file are kept for restoring, 0 turns the history off" ) },
+		{ GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, HistoryMaxKilobytes ),
+		  LOCTEXT( "HistoryMaxKilobytesTooltip", "Compressed size the history of one file may grow to before its oldest versions are dropped" ) },
+	};
+
+	for( const TPair< FName, FText >& Option: Options )
+	{
+		const TSharedPtr< IPropertyHandle > OptionHandle    = StructHandle->GetChildHandle( Option.Key );
+		const FSimpleDelegate               OnOptionChanged = FSimpleDelegate::CreateLambda( [this]
+		{
+			if( UOmniSyncSettings* Config = ConfigObject.Get() )
+				Config->OnOptionsChanged();
+		} );
+
+		// The rule lists report edits of their elements as child changes
+		OptionHandle->SetToolTipText( Option.Value );
+		OptionHandle->SetOnPropertyValueChanged( OnOptionChanged );
+		OptionHandle->SetOnChildPropertyValueChanged( OnOptionChanged );
+		OptionsCategory.AddProperty( OptionHandle );
+	}
+
 	RefreshTreeData( DetailBuilder );
 
 	IDetailCategoryBuilder& FilesCategory = DetailBuilder.EditCategory( "Configs", LOCTEXT( "Configs", "Configs" ), ECategoryPriority::Default );
 	FilesCategory.AddCustomRow( LOCTEXT( "FilesTreeRow", "Files Tree" ) ).WholeRowContent()
 	[
-		SAssignNew( TreeView, STreeView< TSharedRef< FConfigTreeItem > > )
-		.TreeItemsSource( &RootItems )
-		.OnGenerateRow( this, &FOmniSyncCustomization::OnGenerateRow )
-		.OnGetChildren( this, &FOmniSyncCustomization::OnGetChildren )
-		.SelectionMode( ESelectionMode::None )
+		SNew( SVerticalBox )
+
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding( 0, 0, 0, 4 )
+		[
+			SNew( SSearchBox )
+			.HintText( LOCTEXT( "FilterHint", "Filter config files" ) )
+			.OnTextChanged( this, &FOmniSyncCustomization::OnFilterTextChanged )
+		]
+
+		// The tree only virtualizes its rows when its height is bounded, otherwise the details panel asks for every row
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew( SBox )
+			.MaxDesiredHeight( 480.0f )
+			[
+				SAssignNew( TreeView, STreeView< TSharedRef< FConfigTreeItem > > )
+				.TreeItemsSource( &RootItems )
+				.OnGenerateRow( this, &FOmniSyncCustomization::OnGenerateRow )
+				.OnGetChildren( this, &FOmniSyncCustomization::OnGetChildren )
+				.SelectionMode( ESelectionMode::None )
+			]
+		]
 	];
 }
 
 void FOmniSyncCustomization::RefreshTreeData( const IDetailLayoutBuilder& DetailBuilder )
 {
 	TRACE_CPU_SCOPE;
+
 	RootItems.Empty();
+	ViewModels.Empty();
+	Revision++;
+	SortedSettings.Empty();
+	SortedPaths.Empty();
 
-	if( !ConfigObject.IsValid() )
+	const UOmniSyncSettings* Config = ConfigObject.Get();
+	if( !Config )
 		return;
 
-	const TSharedRef< IPropertyHandle > StructHandle   = DetailBuilder.GetProperty( GET_MEMBER_NAME_CHECKED( UOmniSyncSettings, ConfigFileSettingsStruct ) );
-	const TSharedPtr< IPropertyHandle > SettingsHandle = StructHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, Settings ) );
+	const TSharedRef< IPropertyHandle > StructHandle = DetailBuilder.GetProperty( GET_MEMBER_NAME_CHECKED( UOmniSyncSettings, ConfigFileSettingsStruct ) );
+	SettingsHandle                                   = StructHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettingsStruct, Settings ) );
 
 	if( !SettingsHandle.IsValid() )
 		return;
 
-	uint32 NumElements = 0;
-	SettingsHandle->GetNumChildren( NumElements );
+	// Paths are read straight from the settings, property handles are only created once a file row becomes visible
+	const TArray< FConfigFileSettings >& Settings = Config->ConfigFileSettingsStruct.Settings;
+
+	TArray< FString > Paths;
+	Paths.Reserve( Settings.Num() );
+	SortedSettings.Reserve( Settings.Num() );
+	for( int32 Index = 0; Index < Settings.Num(); ++Index )
+	{
+		Paths.Add( UOmniSyncSettings::NormalizeRelativePath( Settings[ Index ].RelativePath ) );
+		SortedSettings.Add( Index );
+	}
+
+	// Sorting keeps every folder's files in one contiguous range, which is all a folder item needs to remember
+	SortedSettings.Sort( [&Paths]( const int32 A, const int32 B ) { return Paths[ A ] < Paths[ B ]; } );
+
+	SortedPaths.Reserve( Paths.Num() );
+	for( const int32 Index: SortedSettings )
+		SortedPaths.Add( MoveTemp( Paths[ Index ] ) );
+
+	SearchIndex.Reset( SortedPaths );
+	RebuildRootItems();
+}
+
+void FOmniSyncCustomization::RebuildRootItems()
+{
+	TRACE_CPU_SCOPE;
+
+	if( FilterText.IsEmpty() )
+	{
+		VisibleEntries.SetNumUninitialized( SortedPaths.Num() );
+		for( int32 Index = 0; Index < SortedPaths.Num(); ++Index )
+			VisibleEntries[ Index ] = Index;
+	}
+	else
+	{
+		VisibleEntries = SearchIndex.Query( FilterText );
+	}
+
+	RootItems.Reset();
+	BuildChildren( 0, VisibleEntries.Num(), 0, RootItems );
+
+	// A narrow filter is easier to read fully expanded, a wide one would build the whole tree again
+	constexpr int32 MaxExpandedMatches = 256;
+	if( !FilterText.IsEmpty() && VisibleEntries.Num() <= MaxExpandedMatches )
+		ExpandAll( RootItems );
+
+	if( TreeView.IsValid() )
+		TreeView->RequestTreeRefresh();
+}
 
-	TMap< FString, TSharedRef< FConfigTreeItem > > FolderCache;
+void FOmniSyncCustomization::BuildChildren( const int32 FirstEntry, const int32 EndEntry, const int32 PrefixLength, TArray< TSharedRef< FConfigTreeItem > >& OutItems )
+{
+	TRACE_CPU_SCOPE;
 
-	for( uint32 i = 0; i < NumElements; ++i )
+	int32 Entry = FirstEntry;
+	while( Entry < EndEntry )
 	{
-		TSharedPtr< IPropertyHandle > ElementHandle = SettingsHandle->GetChildHandle( i );
-		if( !ElementHandle.IsValid() )
+		const FString& Path  = SortedPaths[ VisibleEntries[ Entry ] ];
+		const int32    Slash = Path.Find( TEXT( "/" ), ESearchCase::CaseSensitive, ESearchDir::FromStart, PrefixLength );
+
+		if( Slash == INDEX_NONE )
+		{
+			OutItems.Add( MakeFileItem( VisibleEntries[ Entry ] ) );
+			Entry++;
 			continue;
+		}
 
-		FString FullRelativePath;
-		ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, RelativePath ) )->GetValue( FullRelativePath );
-		FullRelativePath.ReplaceInline( TEXT( "\\" ), TEXT( "/" ) );
+		const FStringView FolderPrefix( *Path, Slash + 1 );
 
-		FString FileName;
-		ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, FileName ) )->GetValue( FileName );
+		int32 FolderEnd = Entry + 1;
+		while( FolderEnd < EndEntry && FStringView( SortedPaths[ VisibleEntries[ FolderEnd ] ] ).StartsWith( FolderPrefix, ESearchCase::IgnoreCase ) )
+			FolderEnd++;
 
-		TArray< FString > PathParts;
-		FullRelativePath.ParseIntoArray( PathParts, TEXT( "/" ) );
+		TSharedRef< FConfigTreeItem > Folder = MakeShared< FConfigTreeItem >();
+		Folder->Name                         = Path.Mid( PrefixLength, Slash - PrefixLength );
+		Folder->FullPath                     = Path.Left( Slash );
+		Folder->bIsFolder                    = true;
+		Folder->FirstEntry                   = Entry;
+		Folder->EndEntry                     = FolderEnd;
+		OutItems.Add( Folder );
 
-		TSharedPtr< FConfigTreeItem > CurrentParent  = nullptr;
-		FString                       CumulativePath = "";
+		Entry = FolderEnd;
+	}
+}
 
-		for( int32 j = 0; j < PathParts.Num() - 1; ++j )
+void FOmniSyncCustomization::ExpandAll( const TArray< TSharedRef< FConfigTreeItem > >& Items )
+{
+	if( !TreeView.IsValid() )
+		return;
+
+	TArray< TSharedRef< FConfigTreeItem > > Children;
+	for( const TSharedRef< FConfigTreeItem >& Item: Items )
+	{
+		if( !Item->bIsFolder )
+			continue;
+
+		TreeView->SetItemExpansion( Item, true );
+		OnGetChildren( Item, Children );
+		ExpandAll( Children );
+	}
+}
+
+TSharedRef< FConfigTreeItem > FOmniSyncCustomization::MakeFileItem( const int32 SortedIndex )
+{
+	const int32    SettingsIndex = SortedSettings[ SortedIndex ];
+	const FString& RelativePath  = SortedPaths[ SortedIndex ];
+
+	// A filter change reuses the view model instead of binding the change delegates of its handles again
+	TSharedRef< FConfigRowViewModel >* CachedViewModel = ViewModels.Find( RelativePath );
+	if( !CachedViewModel )
+	{
+		const TSharedRef< FConfigRowViewModel > ViewModel = MakeShared< FConfigRowViewModel >();
+		ViewModel->SettingsIndex                          = SettingsIndex;
+		if( const TSharedPtr< IPropertyHandle > ElementHandle = SettingsHandle->GetChildHandle( SettingsIndex ) )
 		{
-			FString PartName = PathParts[ j ];
-			CumulativePath   += ( j == 0 ? "" : "/" ) + PartName;
+			ViewModel->Handles.EnabledHandle  = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, bEnabled ) );
+			ViewModel->Handles.ScopeHandle    = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, SettingsScope ) );
+			ViewModel->Handles.AutoSyncHandle = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, bAutoSyncEnabled ) );
+			ViewModel->Handles.LayeredHandle  = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, bLayered ) );
+		}
 
-			if( !FolderCache.Contains( CumulativePath ) )
-			{
-				TSharedRef< FConfigTreeItem > NewFolder = MakeShared< FConfigTreeItem >();
-				NewFolder->Name                         = PartName;
-				NewFolder->FullPath                     = CumulativePath;
-				NewFolder->bIsFolder                    = true;
+		const EConfigRowStatus* Status = SyncStatus.Find( RelativePath );
+		ViewModel->SetStatus( Status ? *Status : EConfigRowStatus::None );
+		RefreshViewModel( *ViewModel );
 
-				if( CurrentParent.IsValid() )
-					CurrentParent->Children.Add( NewFolder );
-				else
-					RootItems.Add( NewFolder );
+		// Each handle reports its own entry, so only that file is saved or copied
+		const FSimpleDelegate OnEntryChanged = FSimpleDelegate::CreateLambda( [this, RelativePath, WeakViewModel = ViewModel.ToWeakPtr()]
+		{
+			if( UOmniSyncSettings* Config = ConfigObject.Get() )
+				Config->OnSettingsChanged( RelativePath );
 
-				FolderCache.Add( CumulativePath, NewFolder );
-			}
+			if( const TSharedPtr< FConfigRowViewModel > PinnedViewModel = WeakViewModel.Pin() )
+				RefreshViewModel( *PinnedViewModel );
+		} );
 
-			CurrentParent = FolderCache[ CumulativePath ];
+		for( const TSharedPtr< IPropertyHandle >& Handle: { ViewModel->Handles.EnabledHandle, ViewModel->Handles.ScopeHandle, ViewModel->Handles.AutoSyncHandle, ViewModel->Handles.LayeredHandle } )
+		{
+			if( Handle.IsValid() )
+				Handle->SetOnPropertyValueChanged( OnEntryChanged );
 		}
 
-		const TSharedRef< FPropertyHandles > PropertyHandles = MakeShared< FPropertyHandles >();
-		PropertyHandles->EnabledHandle                       = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, bEnabled ) );
-		PropertyHandles->ScopeHandle                         = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, SettingsScope ) );
-		PropertyHandles->AutoSyncHandle                      = ElementHandle->GetChildHandle( GET_MEMBER_NAME_CHECKED( FConfigFileSettings, bAutoSyncEnabled ) );
-
-		TSharedRef< FConfigTreeItem > SettingItem = MakeShared< FConfigTreeItem >();
-		SettingItem->Name                         = FileName;
-		SettingItem->FullPath                     = FullRelativePath;
-		SettingItem->bIsSettings                  = true;
-		SettingItem->PropertyHandles              = PropertyHandles;
-
-		TSharedRef< FConfigTreeItem > FileItem = MakeShared< FConfigTreeItem >();
-		FileItem->Name                         = FileName;
-		FileItem->FullPath                     = FullRelativePath;
-		FileItem->PropertyHandles              = PropertyHandles;
-		FileItem->Children.Add( SettingItem );
-
-		if( CurrentParent.IsValid() )
-			CurrentParent->Children.Add( FileItem );
+		CachedViewModel = &ViewModels.Add( RelativePath, ViewModel );
+	}
+
+	const UOmniSyncSettings* Config = ConfigObject.Get();
+
+	TSharedRef< FConfigTreeItem > FileItem = MakeShared< FConfigTreeItem >();
+	FileItem->Name                         = Config && Config->ConfigFileSettingsStruct.Settings.IsValidIndex( SettingsIndex ) ? Config->ConfigFileSettingsStruct.Settings[ SettingsIndex ].FileName : FPaths::GetCleanFilename( RelativePath );
+	FileItem->FullPath                     = RelativePath;
+	FileItem->SettingsIndex                = SettingsIndex;
+	FileItem->ViewModel                    = *CachedViewModel;
+	return FileItem;
+}
+
+void FOmniSyncCustomization::RefreshViewModel( FConfigRowViewModel& ViewModel )
+{
+	const UOmniSyncSettings* Config = ConfigObject.Get();
+	if( !Config || !Config->ConfigFileSettingsStruct.Settings.IsValidIndex( ViewModel.SettingsIndex ) )
+		return;
+
+	ViewModel.Update( Config->ConfigFileSettingsStruct.Settings[ ViewModel.SettingsIndex ] );
+	Revision++;
+}
+
+void FOmniSyncCustomization::OnGetChildren( TSharedRef< FConfigTreeItem > InItem, TArray< TSharedRef< FConfigTreeItem > >& OutChildren )
+{
+	if( !InItem->bChildrenBuilt && !InItem->bIsSettings )
+	{
+		if( InItem->bIsFolder )
+		{
+			BuildChildren( InItem->FirstEntry, InItem->EndEntry, InItem->FullPath.Len() + 1, InItem->Children );
+		}
 		else
-			RootItems.Add( FileItem );
+		{
+			TSharedRef< FConfigTreeItem > SettingItem = MakeShared< FConfigTreeItem >();
+			SettingItem->Name                         = InItem->Name;
+			SettingItem->FullPath                     = InItem->FullPath;
+			SettingItem->bIsSettings                  = true;
+			SettingItem->SettingsIndex                = InItem->SettingsIndex;
+			SettingItem->ViewModel                    = InItem->ViewModel;
+			InItem->Children.Add( SettingItem );
+		}
+
+		InItem->bChildrenBuilt = true;
 	}
 
-	if( TreeView.IsValid() )
-		TreeView->RequestTreeRefresh();
+	OutChildren = InItem->Children;
+}
+
+ECheckBoxState FOmniSyncCustomization::GetFolderCheckState( FConfigTreeItem& Folder ) const
+{
+	const UOmniSyncSettings* Config = ConfigObject.Get();
+	if( !Config )
+		return ECheckBoxState::Unchecked;
+
+	if( Folder.CheckStateRevision == Revision )
+		return Folder.CheckState;
+
+	const TArray< FConfigFileSettings >& Settings = Config->ConfigFileSettingsStruct.Settings;
+	const int32                          EndEntry = FMath::Min( Folder.EndEntry, VisibleEntries.Num() );
+
+	int32 NumEnabled = 0;
+	for( int32 Entry = Folder.FirstEntry; Entry < EndEntry; ++Entry )
+	{
+		const int32 SettingsIndex = SortedSettings[ VisibleEntries[ Entry ] ];
+		if( Settings.IsValidIndex( SettingsIndex ) && Settings[ SettingsIndex ].bEnabled )
+			NumEnabled++;
+	}
+
+	Folder.CheckState         = NumEnabled == 0 ? ECheckBoxState::Unchecked : NumEnabled == EndEntry - Folder.FirstEntry ? ECheckBoxState::Checked : ECheckBoxState::Undetermined;
+	Folder.CheckStateRevision = Revision;
+	return Folder.CheckState;
+}
+
+void FOmniSyncCustomization::SetFolderEnabled( const FConfigTreeItem& Folder, const bool bEnabled )
+{
+	TRACE_CPU_SCOPE;
+
+	UOmniSyncSettings* Config = ConfigObject.Get();
+	if( !Config )
+		return;
+
+	const int32 EndEntry = FMath::Min( Folder.EndEntry, VisibleEntries.Num() );
+
+	TArray< FString > RelativePaths;
+	RelativePaths.Reserve( EndEntry - Folder.FirstEntry );
+	for( int32 Entry = Folder.FirstEntry; Entry < EndEntry; ++Entry )
+		RelativePaths.Add( SortedPaths[ VisibleEntries[ Entry ] ] );
+
+	// One batched change, so the settings write and the push of newly enabled files each happen once
+	Config->SetSettingsEnabled( RelativePaths, bEnabled );
+
+	// The bulk change bypasses the property handles, so the rows that already exist are refreshed here
+	for( const FString& RelativePath: RelativePaths )
+	{
+		if( const TSharedRef< FConfigRowViewModel >* ViewModel = ViewModels.Find( RelativePath ) )
+			RefreshViewModel( **ViewModel );
+	}
+
+	Revision++;
 }
 
-TSharedRef< ITableRow > FOmniSyncCustomization::OnGenerateRow( TSharedRef< FConfigTreeItem > InItem, const TSharedRef< STableViewBase >& OwnerTable ) const
+void FOmniSyncCustomization::OnFilterTextChanged( const FText& Text )
+{
+	TRACE_CPU_SCOPE;
+
+	FString NewFilterText = Text.ToString().TrimStartAndEnd();
+	if( NewFilterText == FilterText )
+		return;
+
+	FilterText = MoveTemp( NewFilterText );
+	RebuildRootItems();
+}
+
+void FOmniSyncCustomization::OnFilesSynced( const TArray< FString >& SyncedFiles, const TArray< FString >& FailedFiles )
+{
+	TRACE_CPU_SCOPE;
+
+	auto SetStatus = [this]( const TArray< FString >& Files, const EConfigRowStatus Status )
+	{
+		for( const FString& File: Files )
+		{
+			FString NormalizedPath = UOmniSyncSettings::NormalizeRelativePath( File );
+			if( const TSharedRef< FConfigRowViewModel >* ViewModel = ViewModels.Find( NormalizedPath ) )
+				( *ViewModel )->SetStatus( Status );
+
+			SyncStatus.Add( MoveTemp( NormalizedPath ), Status );
+		}
+	};
+
+	SetStatus( SyncedFiles, EConfigRowStatus::Synced );
+	SetStatus( FailedFiles, EConfigRowStatus::Failed );
+}
+
+TSharedRef< SWidget > FOmniSyncCustomization::MakeHistoryMenu( const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	FMenuBuilder MenuBuilder( true, nullptr );
+	MenuBuilder.AddMenuEntry( LOCTEXT( "LoadingHistory", "Loading versions..." ), FText::GetEmpty(), FSlateIcon(), FUIAction( FExecuteAction(), FCanExecuteAction::CreateLambda( [] { return false; } ) ) );
+
+	const TSharedRef< SBox > MenuBox = SNew( SBox )[ MenuBuilder.MakeWidget() ];
+
+	// Read on the worker each time the menu opens, so it lists whatever the last sync added without stalling the editor
+	if( UOmniSyncSettings* Config = ConfigObject.Get() )
+	{
+		Config->LoadHistory( RelativePath, FOnHistoryLoaded::CreateLambda( [this, RelativePath, WeakMenuBox = MenuBox.ToWeakPtr()]( const TArray< FOmniSyncHistoryVersion >& Versions )
+		{
+			// A menu that was closed in the meantime took the customization's interest in the versions with it
+			if( const TSharedPtr< SBox > PinnedMenuBox = WeakMenuBox.Pin() )
+				PinnedMenuBox->SetContent( MakeHistoryEntries( RelativePath, Versions ) );
+		} ) );
+	}
+
+	return MenuBox;
+}
+
+TSharedRef< SWidget > FOmniSyncCustomization::MakeHistoryEntries( const FString& RelativePath, const TArray< FOmniSyncHistoryVersion >& Versions )
+{
+	TRACE_CPU_SCOPE;
+
+	FMenuBuilder MenuBuilder( true, nullptr );
+	if( Versions.IsEmpty() )
+	{
+		MenuBuilder.AddMenuEntry( LOCTEXT( "NoHistory", "No stored versions yet" ), FText::GetEmpty(), FSlateIcon(), FUIAction( FExecuteAction(), FCanExecuteAction::CreateLambda( [] { return false; } ) ) );
+		return MenuBuilder.MakeWidget();
+	}
+
+	for( int32 Index = 0; Index < Versions.Num(); ++Index )
+	{
+		const FOmniSyncHistoryVersion& Version = Versions[ Index ];
+		const FText                    Label   = FText::Format( LOCTEXT( "HistoryVersion", "Version {0} - {1} ({2}){3}" ),
+		                                                        FText::AsNumber( Version.Version ),
+		                                                        FText::AsDateTime( Version.Time ),
+		                                                        FText::AsMemory( Version.Size ),
+		                                                        Index == 0 ? LOCTEXT( "CurrentVersion", " - current" ) : FText::GetEmpty() );
+
+		MenuBuilder.AddMenuEntry( Label, FText::GetEmpty(), FSlateIcon(), FUIAction( FExecuteAction::CreateLambda( [this, RelativePath, VersionNumber = Version.Version]
+		{
+			if( UOmniSyncSettings* Settings = ConfigObject.Get() )
+				Settings->RestoreVersion( RelativePath, VersionNumber, MakeSyncNotification( LOCTEXT( "RestoreSucceeded", "Version restored" ), LOCTEXT( "RestoreFailed", "Restoring the version failed" ) ) );
+		} ) ) );
+	}
+
+	return MenuBuilder.MakeWidget();
+}
+
+TSharedRef< ITableRow > FOmniSyncCustomization::OnGenerateRow( TSharedRef< FConfigTreeItem > InItem, const TSharedRef< STableViewBase >& OwnerTable )
 {
 	if( InItem->bIsFolder )
 	{
 		return SNew( STableRow< TSharedRef< FConfigTreeItem > >, OwnerTable )
 			[
-				SNew( STextBlock )
-				.Text( FText::FromString( InItem->Name ) )
-				.Font( IDetailLayoutBuilder::GetDetailFontBold() )
+				SNew( SHorizontalBox )
+
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding( 0, 0, 8, 0 )
+				.VAlign( VAlign_Center )
+				[
+					SNew( SCheckBox )
+					.ToolTipText( LOCTEXT( "FolderEnabledTooltip", "Enable or disable every file in this folder that matches the filter" ) )
+					.IsChecked_Lambda( [this, InItem] { return GetFolderCheckState( *InItem ); } )
+					.OnCheckStateChanged_Lambda( [this, InItem]( const ECheckBoxState NewState ) { SetFolderEnabled( *InItem, NewState == ECheckBoxState::Checked ); } )
+				]
+
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign( VAlign_Center )
+				[
+					SNew( STextBlock )
+					.Text( FText::FromString( InItem->Name ) )
+					.Font( IDetailLayoutBuilder::GetDetailFontBold() )
+				]
 			];
 	}
 
+	const TSharedRef< FConfigRowViewModel > ViewModel = InItem->ViewModel.ToSharedRef();
+
 	if( !InItem->bIsSettings )
 	{
 		return SNew( STableRow< TSharedRef< FConfigTreeItem > >, OwnerTable )
@@ -200,22 +640,11 @@ TSharedRef< ITableRow > FOmniSyncCustomization::OnGenerateRow( TSharedRef< FConf
 				.VAlign( VAlign_Center )
 				[
 					SNew( SCheckBox )
-					.IsChecked_Lambda( [InItem]
-					{
-						bool bVal = false;
-						if( InItem->PropertyHandles && InItem->PropertyHandles->EnabledHandle.IsValid() )
-							InItem->PropertyHandles->EnabledHandle->GetValue( bVal );
-
-						return bVal ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
-					} )
-					.OnCheckStateChanged_Lambda( [InItem, this]( const ECheckBoxState NewState )
+					.IsChecked_Lambda( [ViewModel] { return ViewModel->bEnabled ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; } )
+					.OnCheckStateChanged_Lambda( [ViewModel]( const ECheckBoxState NewState )
 					{
-						if( InItem->PropertyHandles && InItem->PropertyHandles->EnabledHandle.IsValid() )
-						{
-							InItem->PropertyHandles->EnabledHandle->SetValue( NewState == ECheckBoxState::Checked );
-							if( ConfigObject.IsValid() )
-								ConfigObject->OnSettingsChanged();
-						}
+						if( ViewModel->Handles.EnabledHandle.IsValid() )
+							ViewModel->Handles.EnabledHandle->SetValue( NewState == ECheckBoxState::Checked );
 					} )
 				]
 
@@ -235,67 +664,30 @@ TSharedRef< ITableRow > FOmniSyncCustomization::OnGenerateRow( TSharedRef< FConf
 				.VAlign( VAlign_Center )
 				[
 					SNew( STextBlock )
-					.Text_Lambda( [InItem]
-					{
-						bool bEnabled = false;
-						if( InItem->PropertyHandles && InItem->PropertyHandles->EnabledHandle.IsValid() )
-							InItem->PropertyHandles->EnabledHandle->GetValue( bEnabled );
-
-						if( !bEnabled )
-							return LOCTEXT( "Disabled", "Disabled" );
-
-						if( InItem->PropertyHandles && InItem->PropertyHandles->ScopeHandle.IsValid() )
-						{
-							uint8 ScopeValue = 0;
-							InItem->PropertyHandles->ScopeHandle->GetValue( ScopeValue );
-							switch( static_cast< EOmniSyncScope >( ScopeValue ) )
-							{
-								case EOmniSyncScope::Global:
-									return LOCTEXT( "ScopeGlobal", "Global" );
-								case EOmniSyncScope::PerEngineVersion:
-									return LOCTEXT( "ScopePerEngineVersion", "Per Engine Version" );
-								case EOmniSyncScope::PerProject:
-									return LOCTEXT( "ScopePerProject", "Per Project" );
-							}
-						}
-						return FText::GetEmpty();
-					} )
+					.Text_Lambda( [ViewModel] { return ViewModel->ScopeText; } )
 					.Font( IDetailLayoutBuilder::GetDetailFont() )
-					.ColorAndOpacity_Lambda( [InItem]()
-					{
-						bool bEnabled = false;
-						if( InItem->PropertyHandles && InItem->PropertyHandles->ScopeHandle.IsValid() )
-							InItem->PropertyHandles->EnabledHandle->GetValue( bEnabled );
-						return bEnabled ? FLinearColor( 0.7f, 0.7f, 1.0f ) : FLinearColor( 0.5f, 0.5f, 0.5f );
-					} )
+					.ColorAndOpacity_Lambda( [ViewModel] { return ViewModel->ScopeColor; } )
 				]
 
 				+ SHorizontalBox::Slot()
 				.AutoWidth()
+				.Padding( 0, 0, 12, 0 )
 				.VAlign( VAlign_Center )
 				[
 					SNew( STextBlock )
-					.Text_Lambda( [InItem]
-					{
-						bool bEnabled = false;
-						if( InItem->PropertyHandles && InItem->PropertyHandles->ScopeHandle.IsValid() )
-							InItem->PropertyHandles->EnabledHandle->GetValue( bEnabled );
-						if( !bEnabled )
-							return FText::GetEmpty();
-
-						bool bAutoSync = false;
-						if( InItem->PropertyHandles && InItem->PropertyHandles->ScopeHandle.IsValid() )
-							InItem->PropertyHandles->AutoSyncHandle->GetValue( bAutoSync );
-						return bAutoSync ? LOCTEXT( "AutoSyncOn", "[Auto-Sync]" ) : LOCTEXT( "ManualSync", "[Manual]" );
-					} )
+					.Text_Lambda( [ViewModel] { return ViewModel->SyncModeText; } )
 					.Font( IDetailLayoutBuilder::GetDetailFont() )
-					.ColorAndOpacity_Lambda( [InItem]
-					{
-						bool bAutoSync = false;
-						if( InItem->PropertyHandles && InItem->PropertyHandles->ScopeHandle.IsValid() )
-							InItem->PropertyHandles->AutoSyncHandle->GetValue( bAutoSync );
-						return bAutoSync ? FLinearColor( 0.3f, 1.0f, 0.3f ) : FLinearColor( 0.5f, 0.5f, 0.5f );
-					} )
+					.ColorAndOpacity_Lambda( [ViewModel] { return ViewModel->SyncModeColor; } )
+				]
+
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign( VAlign_Center )
+				[
+					SNew( STextBlock )
+					.Text_Lambda( [ViewModel] { return ViewModel->StatusText; } )
+					.Font( IDetailLayoutBuilder::GetDetailFont() )
+					.ColorAndOpacity_Lambda( [ViewModel] { return ViewModel->StatusColor; } )
 				]
 			];
 	}
@@ -327,9 +719,9 @@ TSharedRef< ITableRow > FOmniSyncCustomization::OnGenerateRow( TSharedRef< FConf
 					+ SHorizontalBox::Slot()
 					.AutoWidth()
 					[
-						InItem->PropertyHandles->ScopeHandle
+						ViewModel->Handles.ScopeHandle
 						.IsValid()
-							? InItem->PropertyHandles->ScopeHandle->CreatePropertyValueWidget()
+							? ViewModel->Handles.ScopeHandle->CreatePropertyValueWidget()
 							: SNullWidget::NullWidget
 					]
 				]
@@ -351,12 +743,53 @@ TSharedRef< ITableRow > FOmniSyncCustomization::OnGenerateRow( TSharedRef< FConf
 					+ SHorizontalBox::Slot()
 					.AutoWidth()
 					[
-						InItem->PropertyHandles->AutoSyncHandle
+						ViewModel->Handles.AutoSyncHandle
 						.IsValid()
-							? InItem->PropertyHandles->AutoSyncHandle->CreatePropertyValueWidget()
+							? ViewModel->Handles.AutoSyncHandle->CreatePropertyValueWidget()
 							: SNullWidget::NullWidget
 					]
 				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.HAlign( HAlign_Left )
+				[
+					SNew( SHorizontalBox )
+					+ SHorizontalBox::Slot()
+					.AutoWidth()
+					.VAlign( VAlign_Center )
+					.Padding( 0, 0, 8, 0 )
+					[
+						SNew( STextBlock )
+						.Text( LOCTEXT( "Layered", "Layered" ) )
+						.ToolTipText( LOCTEXT( "LayeredTooltip", "Resolve the file as Global, then Per Engine Version, then Per Project up to its scope, and store only the keys this scope overrides" ) )
+						.Font( IDetailLayoutBuilder::GetDetailFont() )
+					]
+					+ SHorizontalBox::Slot()
+					.AutoWidth()
+					[
+						ViewModel->Handles.LayeredHandle
+						.IsValid()
+							? ViewModel->Handles.LayeredHandle->CreatePropertyValueWidget()
+							: SNullWidget::NullWidget
+					]
+				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.HAlign( HAlign_Left )
+				.Padding( 0, 2 )
+				[
+					SNew( SComboButton )
+					.ToolTipText( LOCTEXT( "RestoreVersionTooltip", "Replace the stored and the local copy with an earlier version of this file" ) )
+					.OnGetMenuContent_Lambda( [this, RelativePath = InItem->FullPath] { return MakeHistoryMenu( RelativePath ); } )
+					.ButtonContent()
+					[
+						SNew( STextBlock )
+						.Text( LOCTEXT( "RestoreVersion", "Restore Version" ) )
+						.Font( IDetailLayoutBuilder::GetDetailFont() )
+					]
+				]
 			]
 		];
 }
@@ -0,0 +1,44 @@
+#include "FOmniSyncDirectoryIndex.h"
+
+#include "FOmniSync.h"
+#include "JsonObjectConverter.h"
+#include "Macros.h"
+
+void FOmniSyncDirectoryIndex::Load()
+{
+	TRACE_CPU_SCOPE;
+
+	Data.Directories.Empty();
+
+	FString JsonString;
+	if( !FFileHelper::LoadFileToString( JsonString, *FilePath ) )
+		return;
+
+	if( !FJsonObjectConverter::JsonObjectStringToUStruct( JsonString, &Data ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Discarding unreadable directory index: %s" ), *FilePath );
+		Data.Directories.Empty();
+	}
+}
+
+void FOmniSyncDirectoryIndex::Save() const
+{
+	TRACE_CPU_SCOPE;
+
+	FString OutputString;
+	if( !FJsonObjectConverter::UStructToJsonObjectString( Data, OutputString, 0, 0, 0, nullptr, false ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to convert directory index JSON: %s" ), *FilePath );
+		return;
+	}
+
+	if( !FFileHelper::SaveStringToFile( OutputString, *FilePath ) )
+		UE_LOG( OmniSync, Error, TEXT( "Failed to write directory index: %s" ), *FilePath );
+}
+
+void FOmniSyncDirectoryIndex::Replace( TMap< FString, FOmniSyncDirectoryIndexEntry >&& Directories )
+{
+	TRACE_CPU_SCOPE;
+
+	Data.Directories = MoveTemp( Directories );
+}
\ No newline at end of file
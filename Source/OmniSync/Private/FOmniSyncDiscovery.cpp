@@ -0,0 +1,307 @@
+#include "FOmniSyncDiscovery.h"
+
+#include "Async/ParallelFor.h"
+#include "FOmniSync.h"
+#include "FOmniSyncPathRules.h"
+#include "FOmniSyncStats.h"
+#include "Macros.h"
+
+namespace
+{
+	void BenchmarkDiscovery( const TArray< FString >& Args )
+	{
+		FOmniSyncDiscovery::Benchmark( Args.IsEmpty() ? 10 : FCString::Atoi( *Args[ 0 ] ) );
+	}
+
+	FAutoConsoleCommand BenchmarkDiscoveryCommand( TEXT( "OmniSync.BenchmarkDiscovery" ),
+	                                               TEXT( "Times the legacy and the pruned parallel config discovery. Usage: OmniSync.BenchmarkDiscovery [Iterations]" ),
+	                                               FConsoleCommandWithArgsDelegate::CreateStatic( &BenchmarkDiscovery ) );
+}
+
+FOmniSyncDiscoveryStats& FOmniSyncDiscoveryStats::operator+=( const FOmniSyncDiscoveryStats& Other )
+{
+	Seconds            += Other.Seconds;
+	DirectoriesVisited += Other.DirectoriesVisited;
+	DirectoriesPruned  += Other.DirectoriesPruned;
+	DirectoriesCached  += Other.DirectoriesCached;
+	FilesFound         += Other.FilesFound;
+	return *this;
+}
+
+TArray< FOmniSyncDiscoveryRoot > FOmniSyncDiscovery::GetProjectRoots()
+{
+	TRACE_CPU_SCOPE;
+
+	static const FString ProjectConfigDir = FPaths::ProjectConfigDir();
+	static const FString SavedConfigDir   = FPaths::Combine( FPaths::ProjectSavedDir(), "Config" );
+	static const FString PluginsDir       = FPaths::ProjectPluginsDir();
+
+	return {
+		{ ProjectConfigDir, false },
+		{ SavedConfigDir, true },
+		{ PluginsDir, true },
+	};
+}
+
+TArray< FString > FOmniSyncDiscovery::FindConfigFiles( const TArray< FOmniSyncDiscoveryRoot >& Roots,
+                                                       FOmniSyncDiscoveryStats*                OutStats,
+                                                       FOmniSyncDirectoryIndex*                Index,
+                                                       const FOmniSyncPathRules*               Rules )
+{
+	TRACE_CPU_SCOPE;
+
+	const double       StartTime = FPlatformTime::Seconds();
+	const FWalkContext Context   = { Index, Rules && !Rules->IsEmpty() ? Rules : nullptr };
+
+	FWalkResult RootResult;
+
+	// Recursive roots are split into their immediate subdirectories so a plugins folder with hundreds of entries spreads across workers
+	TArray< FOmniSyncDiscoveryRoot > WorkItems;
+	for( const FOmniSyncDiscoveryRoot& Root: Roots )
+	{
+		if( Context.Rules && Context.Rules->ShouldPruneDirectory( GetProjectRelativePath( Root.Directory ) ) )
+		{
+			++RootResult.Stats.DirectoriesPruned;
+			continue;
+		}
+
+		if( !Root.bRecursive )
+		{
+			WorkItems.Add( Root );
+			continue;
+		}
+
+		TArray< FString > Subdirectories;
+		VisitDirectory( Root.Directory, &Subdirectories, Context, RootResult );
+
+		for( FString& Subdirectory: Subdirectories )
+			WorkItems.Add( { MoveTemp( Subdirectory ), true } );
+	}
+
+	TArray< FWalkResult > WorkItemResults;
+	WorkItemResults.SetNum( WorkItems.Num() );
+
+	ParallelFor( WorkItems.Num(), [&]( const int32 ItemIndex )
+	{
+		WalkDirectory( WorkItems[ ItemIndex ].Directory, WorkItems[ ItemIndex ].bRecursive, Context, WorkItemResults[ ItemIndex ] );
+	} );
+
+	FOmniSyncDiscoveryStats Stats = RootResult.Stats;
+	TSet< FString >         UniqueFiles;
+	UniqueFiles.Append( MoveTemp( RootResult.Files ) );
+	for( FWalkResult& Result: WorkItemResults )
+	{
+		UniqueFiles.Append( MoveTemp( Result.Files ) );
+		RootResult.Directories.Append( MoveTemp( Result.Directories ) );
+		Stats += Result.Stats;
+	}
+
+	// Directories that were not reached this time are dropped, which keeps deleted plugins from lingering in the index
+	if( Index )
+		Index->Replace( MoveTemp( RootResult.Directories ) );
+
+	TArray< FString > ConfigFiles = UniqueFiles.Array();
+	ConfigFiles.Sort();
+
+	Stats.FilesFound = ConfigFiles.Num();
+	Stats.Seconds    = FPlatformTime::Seconds() - StartTime;
+
+	if( OutStats )
+		*OutStats = Stats;
+
+	FOmniSyncStats::AddFilesScanned( Stats.FilesFound );
+	FOmniSyncStats::RecordLatency( EOmniSyncOperation::Discover, Stats.Seconds );
+
+	return ConfigFiles;
+}
+
+void FOmniSyncDiscovery::Benchmark( const int32 Iterations )
+{
+	TRACE_CPU_SCOPE;
+
+	if( Iterations <= 0 )
+		return;
+
+	const TArray< FOmniSyncDiscoveryRoot > Roots        = GetProjectRoots();
+	IPlatformFile&                         PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	double LegacySeconds = 0.0;
+	int32  LegacyFiles   = 0;
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		TArray< FString > AllConfigPaths;
+		for( const FOmniSyncDiscoveryRoot& Root: Roots )
+		{
+			TArray< FString > Files;
+			if( Root.bRecursive )
+				PlatformFile.FindFilesRecursively( Files, *Root.Directory, TEXT( ".ini" ) );
+			else
+				PlatformFile.FindFiles( Files, *Root.Directory, TEXT( ".ini" ) );
+
+			for( const FString& File: Files )
+				AllConfigPaths.AddUnique( File );
+		}
+
+		LegacySeconds += FPlatformTime::Seconds() - StartTime;
+		LegacyFiles   = AllConfigPaths.Num();
+	}
+
+	FOmniSyncDiscoveryStats TotalStats;
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		FOmniSyncDiscoveryStats Stats;
+		FindConfigFiles( Roots, &Stats );
+		TotalStats += Stats;
+	}
+
+	FOmniSyncDirectoryIndex WarmIndex( FString{} );
+	FindConfigFiles( Roots, nullptr, &WarmIndex );
+
+	FOmniSyncDiscoveryStats IndexedStats;
+	for( int32 Iteration = 0; Iteration < Iterations; ++Iteration )
+	{
+		FOmniSyncDiscoveryStats Stats;
+		FindConfigFiles( Roots, &Stats, &WarmIndex );
+		IndexedStats += Stats;
+	}
+
+	const double LegacyMs  = LegacySeconds * 1000.0 / Iterations;
+	const double PrunedMs  = TotalStats.Seconds * 1000.0 / Iterations;
+	const double IndexedMs = IndexedStats.Seconds * 1000.0 / Iterations;
+
+	UE_LOG( OmniSync, Display, TEXT( "Discovery benchmark (%d iterations)" ), Iterations );
+	UE_LOG( OmniSync, Display, TEXT( "  Legacy: %.3f ms, %d files" ), LegacyMs, LegacyFiles );
+	UE_LOG( OmniSync,
+	        Display,
+	        TEXT( "  Pruned parallel: %.3f ms, %d files, %d directories visited, %d pruned" ),
+	        PrunedMs,
+	        TotalStats.FilesFound / Iterations,
+	        TotalStats.DirectoriesVisited / Iterations,
+	        TotalStats.DirectoriesPruned / Iterations );
+	UE_LOG( OmniSync,
+	        Display,
+	        TEXT( "  Warm index: %.3f ms, %d of %d directories served from the index" ),
+	        IndexedMs,
+	        IndexedStats.DirectoriesCached / Iterations,
+	        IndexedStats.DirectoriesVisited / Iterations );
+	UE_LOG( OmniSync, Display, TEXT( "  Speedup: %.2fx, %.2fx with a warm index" ), PrunedMs > 0.0 ? LegacyMs / PrunedMs : 0.0, IndexedMs > 0.0 ? LegacyMs / IndexedMs : 0.0 );
+}
+
+bool FOmniSyncDiscovery::ShouldPruneDirectory( const FString& DirectoryName )
+{
+	// Build output, sources and assets never contain config files worth syncing
+	static const TSet< FString > PrunedDirectoryNames = {
+		TEXT( "Binaries" ),
+		TEXT( "Intermediate" ),
+		TEXT( "Content" ),
+		TEXT( "Source" ),
+		TEXT( "Resources" ),
+		TEXT( "DerivedDataCache" ),
+		TEXT( ".git" ),
+		TEXT( ".vs" ),
+	};
+
+	return PrunedDirectoryNames.Contains( DirectoryName );
+}
+
+FStringView FOmniSyncDiscovery::GetProjectRelativePath( const FString& Path )
+{
+	// Rules are written against project relative paths, and every discovery root lives below the project directory
+	static const FString ProjectDir = FPaths::ProjectDir();
+
+	FStringView RelativePath( Path );
+	if( RelativePath.StartsWith( ProjectDir ) )
+		RelativePath.RightChopInline( ProjectDir.Len() );
+
+	return RelativePath;
+}
+
+void FOmniSyncDiscovery::VisitDirectory( const FString& Directory, TArray< FString >* OutSubdirectories, const FWalkContext& Context, FWalkResult& OutResult )
+{
+	IPlatformFile&                 PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FOmniSyncDirectoryIndex* Index        = Context.Index;
+
+	FOmniSyncDirectoryIndexEntry Entry;
+	bool                         bCached = false;
+
+	// A directory's timestamp only moves when entries are added, removed or renamed, so an unchanged one can skip enumeration
+	if( Index )
+	{
+		const FFileStatData StatData = PlatformFile.GetStatData( *Directory );
+		if( !StatData.bIsValid || !StatData.bIsDirectory )
+			return;
+
+		Entry.Timestamp = StatData.ModificationTime;
+
+		const FOmniSyncDirectoryIndexEntry* CachedEntry = Index->Find( Directory );
+		if( CachedEntry && CachedEntry->Timestamp == StatData.ModificationTime )
+		{
+			Entry   = *CachedEntry;
+			bCached = true;
+		}
+	}
+
+	++OutResult.Stats.DirectoriesVisited;
+
+	if( bCached )
+	{
+		++OutResult.Stats.DirectoriesCached;
+	}
+	else
+	{
+		auto Visitor = [&Entry]( const TCHAR* Path, const bool bIsDirectory )
+		{
+			if( bIsDirectory )
+				Entry.Subdirectories.Add( FPaths::GetCleanFilename( Path ) );
+			else if( FStringView( Path ).EndsWith( TEXT( ".ini" ) ) )
+				Entry.Files.Add( FPaths::GetCleanFilename( Path ) );
+
+			return true;
+		};
+
+		PlatformFile.IterateDirectory( *Directory, Visitor );
+	}
+
+	// The index keeps the unfiltered listing, so changing the rules never requires enumerating again
+	for( const FString& File: Entry.Files )
+	{
+		FString FilePath = FPaths::Combine( Directory, File );
+		if( !Context.Rules || !Context.Rules->IsExcluded( GetProjectRelativePath( FilePath ) ) )
+			OutResult.Files.Add( MoveTemp( FilePath ) );
+	}
+
+	if( OutSubdirectories )
+	{
+		for( const FString& Subdirectory: Entry.Subdirectories )
+		{
+			FString SubdirectoryPath = FPaths::Combine( Directory, Subdirectory );
+			if( ShouldPruneDirectory( Subdirectory ) || ( Context.Rules && Context.Rules->ShouldPruneDirectory( GetProjectRelativePath( SubdirectoryPath ) ) ) )
+				++OutResult.Stats.DirectoriesPruned;
+			else
+				OutSubdirectories->Add( MoveTemp( SubdirectoryPath ) );
+		}
+	}
+
+	if( Index )
+		OutResult.Directories.Add( Directory, MoveTemp( Entry ) );
+}
+
+void FOmniSyncDiscovery::WalkDirectory( const FString& Directory, const bool bRecursive, const FWalkContext& Context, FWalkResult& OutResult )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !bRecursive )
+	{
+		VisitDirectory( Directory, nullptr, Context, OutResult );
+		return;
+	}
+
+	TArray< FString > PendingDirectories = { Directory };
+	while( !PendingDirectories.IsEmpty() )
+	{
+		const FString Current = PendingDirectories.Pop( EAllowShrinking::No );
+		VisitDirectory( Current, &PendingDirectories, Context, OutResult );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "FOmniSyncFileCopy.h"
+
+#include "FOmniSync.h"
+#include "Macros.h"
+
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Spelled out because the engine's sysroot predates both, the kernel has had them since 4.5
+#ifndef FICLONE
+#define FICLONE _IOW( 0x94, 9, int )
+#endif
+
+#ifndef __NR_copy_file_range
+#if defined( __x86_64__ )
+#define __NR_copy_file_range 326
+#elif defined( __aarch64__ )
+#define __NR_copy_file_range 285
+#endif
+#endif
+#endif
+
+FRWLock         FOmniSyncFileCopy::DirectoryLock;
+TSet< FString > FOmniSyncFileCopy::KnownDirectories;
+int32           FOmniSyncFileCopy::BatchDepth = 0;
+
+bool FOmniSyncFileCopy::Copy( const FString& Source, const FString& Destination, EOmniSyncCopyMethod* OutMethod )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !EnsureDirectory( FPaths::GetPath( Destination ) ) )
+		return false;
+
+	// Copied under a name of its own and moved over the destination, so another editor never reads a half written file
+	const FString TempFile = FString::Printf( TEXT( "%s.%s.tmp" ), *Destination, *FGuid::NewGuid().ToString() );
+
+	IPlatformFile&      PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	EOmniSyncCopyMethod Method       = EOmniSyncCopyMethod::Generic;
+	if( !CopyNative( Source, TempFile, Method ) && !PlatformFile.CopyFile( *TempFile, *Source ) )
+	{
+		// The cached directory may have been removed since, it is checked once more before giving up
+		ForgetDirectory( FPaths::GetPath( Destination ) );
+		if( !PlatformFile.FileExists( *Source ) || !EnsureDirectory( FPaths::GetPath( Destination ) ) || !PlatformFile.CopyFile( *TempFile, *Source ) )
+		{
+			PlatformFile.DeleteFile( *TempFile );
+			return false;
+		}
+
+		Method = EOmniSyncCopyMethod::Generic;
+	}
+
+	if( !IFileManager::Get().Move( *Destination, *TempFile, true, true ) )
+	{
+		PlatformFile.DeleteFile( *TempFile );
+		return false;
+	}
+
+	if( OutMethod )
+		*OutMethod = Method;
+
+	return true;
+}
+
+bool FOmniSyncFileCopy::EnsureDirectory( const FString& Directory )
+{
+	TRACE_CPU_SCOPE;
+
+	{
+		FReadScopeLock Lock( DirectoryLock );
+		if( BatchDepth > 0 && KnownDirectories.Contains( Directory ) )
+			return true;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if( !PlatformFile.DirectoryExists( *Directory ) && !PlatformFile.CreateDirectoryTree( *Directory ) )
+		return false;
+
+	FWriteScopeLock Lock( DirectoryLock );
+	if( BatchDepth > 0 )
+		KnownDirectories.Add( Directory );
+
+	return true;
+}
+
+void FOmniSyncFileCopy::ForgetDirectory( const FString& Directory )
+{
+	FWriteScopeLock Lock( DirectoryLock );
+	KnownDirectories.Remove( Directory );
+}
+
+void FOmniSyncFileCopy::BeginBatch()
+{
+	FWriteScopeLock Lock( DirectoryLock );
+	BatchDepth++;
+}
+
+void FOmniSyncFileCopy::EndBatch()
+{
+	// Directories can disappear between batches, nothing is trusted beyond the batch that saw them
+	FWriteScopeLock Lock( DirectoryLock );
+	if( --BatchDepth == 0 )
+		KnownDirectories.Empty();
+}
+
+bool FOmniSyncFileCopy::CopyNative( const FString& Source, const FString& Destination, EOmniSyncCopyMethod& OutMethod )
+{
+#if PLATFORM_LINUX
+	TRACE_CPU_SCOPE;
+
+	const int SourceFd = open( TCHAR_TO_UTF8( *FPaths::ConvertRelativePathToFull( Source ) ), O_RDONLY | O_CLOEXEC );
+	if( SourceFd < 0 )
+		return false;
+
+	struct stat SourceStat;
+	if( fstat( SourceFd, &SourceStat ) != 0 )
+	{
+		close( SourceFd );
+		return false;
+	}
+
+	const int DestinationFd = open( TCHAR_TO_UTF8( *FPaths::ConvertRelativePathToFull( Destination ) ), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644 );
+	if( DestinationFd < 0 )
+	{
+		close( SourceFd );
+		return false;
+	}
+
+	// A reflink shares the extents on btrfs and XFS, no data moves at all
+	bool bCopied = ioctl( DestinationFd, FICLONE, SourceFd ) == 0;
+	if( bCopied )
+		OutMethod = EOmniSyncCopyMethod::Clone;
+
+#ifdef __NR_copy_file_range
+	// Across filesystems or on ext4 the kernel still copies without a round trip through user space
+	if( !bCopied )
+	{
+		int64 Remaining = SourceStat.st_size;
+		while( Remaining > 0 )
+		{
+			const ssize_t Copied = syscall( __NR_copy_file_range, SourceFd, nullptr, DestinationFd, nullptr, static_cast< size_t >( Remaining ), 0u );
+			if( Copied <= 0 )
+				break;
+
+			Remaining -= Copied;
+		}
+
+		bCopied = Remaining == 0;
+		if( bCopied )
+			OutMethod = EOmniSyncCopyMethod::CopyRange;
+		else
+			UE_LOG( OmniSync, VeryVerbose, TEXT( "copy_file_range failed for %s (errno %d), using a buffered copy" ), *Source, errno );
+	}
+#endif
+
+	close( SourceFd );
+	close( DestinationFd );
+	return bCopied;
+#else
+	return false;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "FOmniSyncFileStorage.h"
+
+#include "FOmniSyncManifest.h"
+#include "Macros.h"
+
+bool FOmniSyncFileStorage::GetHash( const EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash )
+{
+	TRACE_CPU_SCOPE;
+	return GetManifest( Scope ).GetHash( RelativePath, GetFilePath( Scope, RelativePath ), OutHash );
+}
+
+bool FOmniSyncFileStorage::Read( const EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes )
+{
+	TRACE_CPU_SCOPE;
+	return FFileHelper::LoadFileToArray( OutBytes, *GetFilePath( Scope, RelativePath ) );
+}
+
+bool FOmniSyncFileStorage::Write( const EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, const uint64 Hash )
+{
+	TRACE_CPU_SCOPE;
+
+	const FString File = GetFilePath( Scope, RelativePath );
+	if( !FFileHelper::SaveArrayToFile( Bytes, *File ) )
+		return false;
+
+	GetManifest( Scope ).Update( RelativePath, File, Hash );
+	return true;
+}
+
+bool FOmniSyncFileStorage::Flush()
+{
+	TRACE_CPU_SCOPE;
+
+	// Files are written straight into the scope, the manifests only cache their hashes and are rebuilt from the files when lost
+	for( const TPair< EOmniSyncScope, TSharedPtr< FOmniSyncManifest > >& Pair: Manifests )
+		Pair.Value->Save();
+
+	return true;
+}
+
+TArray< FString > FOmniSyncFileStorage::GetRelativePaths( const EOmniSyncScope Scope )
+{
+	TRACE_CPU_SCOPE;
+
+	const FString ScopeDir = UOmniSyncSettings::GetScopedSettingsDirectory( Scope );
+
+	TArray< FString > Files;
+	IFileManager::Get().FindFilesRecursive( Files, *ScopeDir, TEXT( "*.ini" ), true, false );
+
+	for( FString& File: Files )
+		FPaths::MakePathRelativeTo( File, *( ScopeDir + TEXT( "/" ) ) );
+
+	return Files;
+}
+
+FString FOmniSyncFileStorage::GetFilePath( const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	return FPaths::Combine( UOmniSyncSettings::GetScopedSettingsDirectory( Scope ), RelativePath );
+}
+
+FOmniSyncManifest& FOmniSyncFileStorage::GetManifest( const EOmniSyncScope Scope )
+{
+	TSharedPtr< FOmniSyncManifest >& Manifest = Manifests.FindOrAdd( Scope );
+	if( !Manifest.IsValid() )
+	{
+		Manifest = MakeShared< FOmniSyncManifest >( FPaths::Combine( UOmniSyncSettings::GetScopedSettingsDirectory( Scope ), "OmniSyncManifest.json" ) );
+		Manifest->Load();
+	}
+
+	return *Manifest;
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "FOmniSyncGenerations.h"
+
+#include "FOmniSync.h"
+#include "FOmniSyncManifest.h"
+#include "JsonObjectConverter.h"
+#include "Macros.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// The owner touches the lock while its job runs, a lock this old was left behind by an editor that crashed or was killed
+	constexpr double StaleLockSeconds     = 30.0;
+	constexpr double LockKeepAliveSeconds = 5.0;
+
+	// Fails when Destination already exists, unlike IPlatformFile::MoveFile which replaces it on POSIX. Source is gone afterwards either way
+	bool LinkExclusive( const FString& Source, const FString& Destination )
+	{
+#if PLATFORM_WINDOWS
+		const bool bLinked = MoveFileExW( *FPaths::ConvertRelativePathToFull( Source ), *FPaths::ConvertRelativePathToFull( Destination ), 0 ) != 0;
+#else
+		const bool bLinked = link( TCHAR_TO_UTF8( *FPaths::ConvertRelativePathToFull( Source ) ), TCHAR_TO_UTF8( *FPaths::ConvertRelativePathToFull( Destination ) ) ) == 0;
+#endif
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile( *Source );
+		return bLinked;
+	}
+}
+
+FOmniSyncGenerations::FOmniSyncGenerations( const FString& Directory )
+	: FilePath( FPaths::Combine( Directory, FileName ) )
+	, LockPath( FPaths::Combine( Directory, TEXT( "OmniSync.lock" ) ) )
+	, LockToken( FString::Printf( TEXT( "%s %u %s" ), FPlatformProcess::ComputerName(), FPlatformProcess::GetCurrentProcessId(), *FGuid::NewGuid().ToString() ) )
+{}
+
+FOmniSyncGenerations::~FOmniSyncGenerations()
+{
+	Release();
+}
+
+bool FOmniSyncGenerations::TryLock( const double TimeoutSeconds )
+{
+	TRACE_CPU_SCOPE;
+
+	if( bLocked )
+		return true;
+
+	const double EndTime = FPlatformTime::Seconds() + TimeoutSeconds;
+	do
+	{
+		if( TryCreateLockFile() )
+		{
+			bLocked       = true;
+			KeepAliveTime = FPlatformTime::Seconds();
+
+			// Another editor may have saved within the same timestamp second, the file is read again whatever its time says
+			Refresh( true );
+			return true;
+		}
+
+		FPlatformProcess::Sleep( 0.05f );
+	}
+	while( FPlatformTime::Seconds() < EndTime );
+
+	return false;
+}
+
+void FOmniSyncGenerations::Release()
+{
+	TRACE_CPU_SCOPE;
+
+	Save();
+
+	if( !bLocked )
+		return;
+
+	bLocked = false;
+
+	// Only remove the lock while it still carries our token, a stale takeover by another editor must not be undone
+	FString Owner;
+	if( FFileHelper::LoadFileToString( Owner, *LockPath ) && Owner == LockToken )
+		IFileManager::Get().Delete( *LockPath, false, true, true );
+}
+
+void FOmniSyncGenerations::KeepAlive()
+{
+	if( !bLocked || FPlatformTime::Seconds() - KeepAliveTime < LockKeepAliveSeconds )
+		return;
+
+	KeepAliveTime = FPlatformTime::Seconds();
+	FPlatformFileManager::Get().GetPlatformFile().SetTimeStamp( *LockPath, FDateTime::UtcNow() );
+}
+
+int64 FOmniSyncGenerations::Get( const FString& RelativePath )
+{
+	if( !bLocked )
+		Refresh();
+
+	KeepAlive();
+
+	const int64* Generation = Data.Generations.Find( RelativePath );
+	return Generation ? *Generation : 0;
+}
+
+int64 FOmniSyncGenerations::Bump( const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !bLocked )
+		Refresh();
+
+	KeepAlive();
+
+	int64& Generation = Data.Generations.FindOrAdd( RelativePath );
+	DirtyPaths.Add( RelativePath );
+	return ++Generation;
+}
+
+void FOmniSyncGenerations::DiscardBumps()
+{
+	TRACE_CPU_SCOPE;
+
+	if( DirtyPaths.IsEmpty() )
+		return;
+
+	DirtyPaths.Empty();
+	Refresh( true );
+}
+
+bool FOmniSyncGenerations::TryCreateLockFile()
+{
+	TRACE_CPU_SCOPE;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	const FDateTime LockTimestamp = PlatformFile.GetTimeStamp( *LockPath );
+	if( LockTimestamp != FDateTime::MinValue() )
+	{
+		if( ( FDateTime::UtcNow() - LockTimestamp ).GetTotalSeconds() < StaleLockSeconds )
+			return false;
+
+		// Moved aside first, so an editor that breaks the same stale lock a moment later cannot delete a lock that was just taken
+		const FString StalePath = FString::Printf( TEXT( "%s.%s.stale" ), *LockPath, *FGuid::NewGuid().ToString() );
+		if( !PlatformFile.MoveFile( *StalePath, *LockPath ) )
+			return false;
+
+		if( ( FDateTime::UtcNow() - PlatformFile.GetTimeStamp( *StalePath ) ).GetTotalSeconds() < StaleLockSeconds )
+		{
+			LinkExclusive( StalePath, LockPath );
+			return false;
+		}
+
+		UE_LOG( OmniSync, Warning, TEXT( "Breaking stale sync lock %s" ), *LockPath );
+		PlatformFile.DeleteFile( *StalePath );
+	}
+
+	// The token is written aside and linked into place, which fails when another editor's lock is already there
+	const FString TempPath = FString::Printf( TEXT( "%s.%s" ), *LockPath, *FGuid::NewGuid().ToString() );
+	if( !FFileHelper::SaveStringToFile( LockToken, *TempPath ) )
+		return false;
+
+	return LinkExclusive( TempPath, LockPath );
+}
+
+void FOmniSyncGenerations::Refresh( const bool bForce )
+{
+	TRACE_CPU_SCOPE;
+
+	const FDateTime Timestamp = IFileManager::Get().GetTimeStamp( *FilePath );
+	if( !bForce && Timestamp == LoadedTimestamp && !FOmniSyncManifest::IsRacy( LoadedTimestamp, LoadedTime ) )
+		return;
+
+	// Bumps that were not saved yet survive the reload, the higher of both numbers wins
+	const TMap< FString, int64 > LocalGenerations = MoveTemp( Data.Generations );
+	Data.Generations.Empty();
+	LoadedTimestamp = Timestamp;
+	LoadedTime      = FDateTime::UtcNow();
+
+	FString JsonString;
+	if( FFileHelper::LoadFileToString( JsonString, *FilePath ) && !FJsonObjectConverter::JsonObjectStringToUStruct( JsonString, &Data ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Discarding unreadable generations: %s" ), *FilePath );
+		Data.Generations.Empty();
+	}
+
+	for( const FString& RelativePath: DirtyPaths )
+	{
+		int64& Generation = Data.Generations.FindOrAdd( RelativePath );
+		Generation        = FMath::Max( Generation, LocalGenerations.FindRef( RelativePath ) );
+	}
+}
+
+void FOmniSyncGenerations::Save()
+{
+	TRACE_CPU_SCOPE;
+
+	if( DirtyPaths.IsEmpty() )
+		return;
+
+	Refresh( true );
+
+	FString OutputString;
+	if( !FJsonObjectConverter::UStructToJsonObjectString( Data, OutputString, 0, 0, 0, nullptr, false ) || !FFileHelper::SaveStringToFile( OutputString, *FilePath ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to write generations: %s" ), *FilePath );
+		return;
+	}
+
+	DirtyPaths.Empty();
+	LoadedTime      = FDateTime::UtcNow();
+	LoadedTimestamp = IFileManager::Get().GetTimeStamp( *FilePath );
+}
\ No newline at end of file
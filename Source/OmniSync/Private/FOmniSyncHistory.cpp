@@ -0,0 +1,258 @@
+#include "FOmniSyncHistory.h"
+
+#include "Algo/BinarySearch.h"
+#include "FOmniSync.h"
+#include "FOmniSyncBlobStorage.h"
+#include "FOmniSyncManifest.h"
+#include "Macros.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 HistoryMagic   = 0x3148534F; // "OSH1"
+	constexpr uint32 HistoryVersion = 1;
+
+	// Restoring decodes at most this many records, at the cost of one full copy per interval
+	constexpr int32 KeyframeInterval = 8;
+}
+
+FOmniSyncHistory::FOmniSyncHistory( const EOmniSyncScope Scope, const FString& RelativePath )
+	: FilePath( GetFilePath( Scope, RelativePath ) )
+{}
+
+bool FOmniSyncHistory::Load()
+{
+	TRACE_CPU_SCOPE;
+
+	Records.Reset();
+
+	TArray< uint8 > Bytes;
+	if( !FFileHelper::LoadFileToArray( Bytes, *FilePath, FILEREAD_Silent ) )
+		return false;
+
+	FMemoryReader Reader( Bytes );
+
+	uint32 Magic   = 0;
+	uint32 Version = 0;
+	int32  Count   = 0;
+	Reader << Magic << Version << Count;
+
+	if( Reader.IsError() || Magic != HistoryMagic || Version > HistoryVersion || Count < 0 || Count > Bytes.Num() )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Ignoring unreadable history: %s" ), *FilePath );
+		return false;
+	}
+
+	Records.SetNum( Count );
+	for( FRecord& Record: Records )
+		Reader << Record;
+
+	if( Reader.IsError() )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Ignoring truncated history: %s" ), *FilePath );
+		Records.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FOmniSyncHistory::Save() const
+{
+	TRACE_CPU_SCOPE;
+
+	uint32 Magic   = HistoryMagic;
+	uint32 Version = HistoryVersion;
+	int32  Count   = Records.Num();
+
+	TArray< uint8 > Bytes;
+	FMemoryWriter   Writer( Bytes );
+	Writer << Magic << Version << Count;
+
+	for( FRecord& Record: const_cast< TArray< FRecord >& >( Records ) )
+		Writer << Record;
+
+	// Written aside and moved over the old file, so a panel listing the versions never reads a half written history
+	const FString TempPath = FString::Printf( TEXT( "%s.%s.tmp" ), *FilePath, *FGuid::NewGuid().ToString() );
+	if( FFileHelper::SaveArrayToFile( Bytes, *TempPath ) && IFileManager::Get().Move( *FilePath, *TempPath, true, true ) )
+		return true;
+
+	IFileManager::Get().Delete( *TempPath, false, false, true );
+	UE_LOG( OmniSync, Warning, TEXT( "Failed to write history: %s" ), *FilePath );
+	return false;
+}
+
+TArray< FOmniSyncHistoryVersion > FOmniSyncHistory::GetVersions() const
+{
+	TArray< FOmniSyncHistoryVersion > Versions;
+	Versions.Reserve( Records.Num() );
+
+	for( int32 Index = Records.Num() - 1; Index >= 0; --Index )
+		Versions.Add( { Records[ Index ].Version, FDateTime( Records[ Index ].Ticks ), Records[ Index ].Size } );
+
+	return Versions;
+}
+
+void FOmniSyncHistory::Add( const int64 Version, const TArray< uint8 >& Bytes )
+{
+	TRACE_CPU_SCOPE;
+
+	const uint64 Hash = FOmniSyncManifest::HashBuffer( Bytes.GetData(), Bytes.Num() );
+	if( !Records.IsEmpty() && Records.Last().Hash == Hash )
+		return;
+
+	int32 SinceKeyframe = 0;
+	while( SinceKeyframe < Records.Num() && !Records[ Records.Num() - 1 - SinceKeyframe ].bKeyframe )
+		SinceKeyframe++;
+
+	TArray< uint8 > Previous;
+	const bool      bDelta = !Records.IsEmpty() && SinceKeyframe + 1 < KeyframeInterval && Decode( Records.Num() - 1, Previous );
+
+	// Versions keep increasing even when the generations file they come from was reset
+	FRecord Record;
+	Record.Version = Records.IsEmpty() ? Version : FMath::Max( Version, Records.Last().Version + 1 );
+	Record.Ticks   = FDateTime::UtcNow().GetTicks();
+	Encode( Record, Bytes, bDelta ? &Previous : nullptr );
+
+	Records.Add( MoveTemp( Record ) );
+}
+
+void FOmniSyncHistory::Trim( const int32 MaxVersions, const int64 MaxBytes )
+{
+	TRACE_CPU_SCOPE;
+
+	int64 TotalBytes = 0;
+	for( const FRecord& Record: Records )
+		TotalBytes += Record.Payload.Num();
+
+	// The newest version always stays, it is what the store holds right now
+	while( Records.Num() > 1 && ( Records.Num() > FMath::Max( MaxVersions, 1 ) || TotalBytes > MaxBytes ) )
+	{
+		// The next version may be a delta against the one being dropped, so it becomes a keyframe first
+		TArray< uint8 > Bytes;
+		if( !Records[ 1 ].bKeyframe && !Decode( 1, Bytes ) )
+		{
+			// A chain that does not decode is dropped up to the next keyframe, or left alone when the newest version is part of it
+			int32 ChainEnd = 2;
+			while( ChainEnd < Records.Num() && !Records[ ChainEnd ].bKeyframe )
+				ChainEnd++;
+
+			UE_LOG( OmniSync, Warning, TEXT( "History has a version that does not decode: %s" ), *FilePath );
+			if( ChainEnd == Records.Num() )
+				break;
+
+			for( int32 Index = 0; Index < ChainEnd; ++Index )
+				TotalBytes -= Records[ Index ].Payload.Num();
+
+			Records.RemoveAt( 0, ChainEnd );
+			continue;
+		}
+
+		if( !Records[ 1 ].bKeyframe )
+		{
+			TotalBytes -= Records[ 1 ].Payload.Num();
+			Encode( Records[ 1 ], Bytes, nullptr );
+			TotalBytes += Records[ 1 ].Payload.Num();
+		}
+
+		TotalBytes -= Records[ 0 ].Payload.Num();
+		Records.RemoveAt( 0 );
+	}
+}
+
+bool FOmniSyncHistory::Restore( const int64 Version, TArray< uint8 >& OutBytes ) const
+{
+	TRACE_CPU_SCOPE;
+
+	const int32 Index = Algo::BinarySearchBy( Records, Version, &FRecord::Version );
+	return Index != INDEX_NONE && Decode( Index, OutBytes );
+}
+
+FString FOmniSyncHistory::GetFilePath( const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	return FPaths::Combine( UOmniSyncSettings::GetScopedSettingsDirectory( Scope ), TEXT( "OmniSyncHistory" ), RelativePath + TEXT( ".history" ) );
+}
+
+bool FOmniSyncHistory::Decode( const int32 Index, TArray< uint8 >& OutBytes ) const
+{
+	TRACE_CPU_SCOPE;
+
+	int32 Keyframe = Index;
+	while( Keyframe >= 0 && !Records[ Keyframe ].bKeyframe )
+		Keyframe--;
+
+	if( Keyframe < 0 || !FOmniSyncBlobStorage::DecodeBlob( Records[ Keyframe ].Payload, OutBytes ) )
+		return false;
+
+	TArray< uint8 > Delta;
+	TArray< uint8 > Bytes;
+	for( int32 Current = Keyframe + 1; Current <= Index; ++Current )
+	{
+		if( !FOmniSyncBlobStorage::DecodeBlob( Records[ Current ].Payload, Delta ) || !ApplyDelta( OutBytes, Delta, Bytes ) )
+			return false;
+
+		Swap( OutBytes, Bytes );
+	}
+
+	// A damaged record would otherwise restore garbage into the store and the project
+	return FOmniSyncManifest::HashBuffer( OutBytes.GetData(), OutBytes.Num() ) == Records[ Index ].Hash;
+}
+
+void FOmniSyncHistory::Encode( FRecord& Record, const TArray< uint8 >& Bytes, const TArray< uint8 >* Previous )
+{
+	Record.Hash      = FOmniSyncManifest::HashBuffer( Bytes.GetData(), Bytes.Num() );
+	Record.Size      = Bytes.Num();
+	Record.bKeyframe = Previous == nullptr;
+
+	if( !Previous )
+	{
+		FOmniSyncBlobStorage::EncodeBlob( Bytes, true, Record.Payload );
+		return;
+	}
+
+	TArray< uint8 > Delta;
+	EncodeDelta( *Previous, Bytes, Delta );
+	FOmniSyncBlobStorage::EncodeBlob( Delta, true, Record.Payload );
+}
+
+void FOmniSyncHistory::EncodeDelta( const TArray< uint8 >& Previous, const TArray< uint8 >& Bytes, TArray< uint8 >& OutDelta )
+{
+	// Edits to an ini file tend to sit in one place, so the unchanged head and tail cover most of it
+	const int32 MaxCommon = FMath::Min( Previous.Num(), Bytes.Num() );
+
+	int32 Prefix = 0;
+	while( Prefix < MaxCommon && Previous[ Prefix ] == Bytes[ Prefix ] )
+		Prefix++;
+
+	int32 Suffix = 0;
+	while( Suffix < MaxCommon - Prefix && Previous[ Previous.Num() - 1 - Suffix ] == Bytes[ Bytes.Num() - 1 - Suffix ] )
+		Suffix++;
+
+	int32 Length = Bytes.Num() - Prefix - Suffix;
+
+	OutDelta.Reset( 3 * sizeof( int32 ) + Length );
+	FMemoryWriter Writer( OutDelta );
+	Writer << Prefix << Suffix << Length;
+	Writer.Serialize( const_cast< uint8* >( Bytes.GetData() + Prefix ), Length );
+}
+
+bool FOmniSyncHistory::ApplyDelta( const TArray< uint8 >& Previous, const TArray< uint8 >& Delta, TArray< uint8 >& OutBytes )
+{
+	int32 Prefix = 0;
+	int32 Suffix = 0;
+	int32 Length = 0;
+
+	FMemoryReader Reader( Delta );
+	Reader << Prefix << Suffix << Length;
+
+	const int64 Offset = Reader.Tell();
+	if( Reader.IsError() || Prefix < 0 || Suffix < 0 || Length < 0 || Prefix + Suffix > Previous.Num() || Offset + Length != Delta.Num() )
+		return false;
+
+	OutBytes.Reset( Prefix + Length + Suffix );
+	OutBytes.Append( Previous.GetData(), Prefix );
+	OutBytes.Append( Delta.GetData() + Offset, Length );
+	OutBytes.Append( Previous.GetData() + Previous.Num() - Suffix, Suffix );
+	return true;
+}
\ No newline at end of file
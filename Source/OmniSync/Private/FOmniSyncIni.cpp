@@ -0,0 +1,277 @@
+#include "FOmniSyncIni.h"
+
+#include "Macros.h"
+
+const FOmniSyncIniKey* FOmniSyncIniSection::FindKey( const FString& Key ) const
+{
+	const int32* Index = KeyIndex.Find( Key );
+	return Index ? &Keys[ *Index ] : nullptr;
+}
+
+void FOmniSyncIniDocument::Parse( const FString& Text )
+{
+	TRACE_CPU_SCOPE;
+
+	Preamble.Empty();
+	Sections.Empty();
+	SectionIndex.Empty();
+
+	TArray< FString > Lines;
+	Text.ParseIntoArrayLines( Lines, false );
+
+	// Trailing line break produces an empty last entry that is not part of the content
+	if( !Lines.IsEmpty() && Lines.Last().IsEmpty() )
+		Lines.Pop();
+
+	FOmniSyncIniSection* CurrentSection = nullptr;
+	TArray< FString >    PendingComments;
+
+	for( FString& Line: Lines )
+	{
+		const FString Trimmed = Line.TrimStartAndEnd();
+
+		if( Trimmed.StartsWith( TEXT( "[" ) ) && Trimmed.EndsWith( TEXT( "]" ) ) )
+		{
+			if( CurrentSection )
+				CurrentSection->TrailingComments.Append( MoveTemp( PendingComments ) );
+			else
+				Preamble.Append( MoveTemp( PendingComments ) );
+
+			PendingComments.Reset();
+			CurrentSection = &FindOrAddSection( Trimmed.Mid( 1, Trimmed.Len() - 2 ) );
+			continue;
+		}
+
+		if( !CurrentSection || Trimmed.IsEmpty() || Trimmed.StartsWith( TEXT( ";" ) ) || Trimmed.StartsWith( TEXT( "#" ) ) )
+		{
+			if( CurrentSection )
+				PendingComments.Add( MoveTemp( Line ) );
+			else
+				Preamble.Add( MoveTemp( Line ) );
+			continue;
+		}
+
+		// Lines are grouped by their key without the +/-/./! prefix so array operations on one key keep their relative order
+		const FString KeyName = GetKeyName( Trimmed );
+		if( const int32* KeyIndex = CurrentSection->KeyIndex.Find( KeyName ) )
+		{
+			FOmniSyncIniKey& Key = CurrentSection->Keys[ *KeyIndex ];
+			Key.LeadingComments.Append( MoveTemp( PendingComments ) );
+			Key.Lines.Add( MoveTemp( Line ) );
+		}
+		else
+		{
+			FOmniSyncIniKey& Key = CurrentSection->Keys.AddDefaulted_GetRef();
+			Key.Name             = KeyName;
+			Key.LeadingComments  = MoveTemp( PendingComments );
+			Key.Lines.Add( MoveTemp( Line ) );
+			CurrentSection->KeyIndex.Add( KeyName, CurrentSection->Keys.Num() - 1 );
+		}
+
+		PendingComments.Reset();
+	}
+
+	if( CurrentSection )
+		CurrentSection->TrailingComments.Append( MoveTemp( PendingComments ) );
+}
+
+FString FOmniSyncIniDocument::ToString() const
+{
+	TRACE_CPU_SCOPE;
+
+	TStringBuilder< 4096 > Builder;
+	auto                   AppendLine = [&Builder]( const FString& Line ) { Builder.Append( Line ).Append( LINE_TERMINATOR ); };
+
+	for( const FString& Line: Preamble )
+		AppendLine( Line );
+
+	for( const FOmniSyncIniSection& Section: Sections )
+	{
+		Builder.Append( TEXT( "[" ) ).Append( Section.Name ).Append( TEXT( "]" ) ).Append( LINE_TERMINATOR );
+
+		for( const FOmniSyncIniKey& Key: Section.Keys )
+		{
+			for( const FString& Line: Key.LeadingComments )
+				AppendLine( Line );
+			for( const FString& Line: Key.Lines )
+				AppendLine( Line );
+		}
+
+		for( const FString& Line: Section.TrailingComments )
+			AppendLine( Line );
+	}
+
+	return Builder.ToString();
+}
+
+const FOmniSyncIniSection* FOmniSyncIniDocument::FindSection( const FString& Section ) const
+{
+	const int32* Index = SectionIndex.Find( Section );
+	return Index ? &Sections[ *Index ] : nullptr;
+}
+
+const TArray< FString >* FOmniSyncIniDocument::FindLines( const FString& Section, const FString& Key ) const
+{
+	const FOmniSyncIniSection* FoundSection = FindSection( Section );
+	if( !FoundSection )
+		return nullptr;
+
+	const FOmniSyncIniKey* FoundKey = FoundSection->FindKey( Key );
+	return FoundKey ? &FoundKey->Lines : nullptr;
+}
+
+void FOmniSyncIniDocument::SetLines( const FString& Section, const FString& Key, const TArray< FString >& Lines )
+{
+	FOmniSyncIniSection& FoundSection = FindOrAddSection( Section );
+	if( const int32* KeyIndex = FoundSection.KeyIndex.Find( Key ) )
+	{
+		FoundSection.Keys[ *KeyIndex ].Lines = Lines;
+		return;
+	}
+
+	FOmniSyncIniKey& NewKey = FoundSection.Keys.AddDefaulted_GetRef();
+	NewKey.Name             = Key;
+	NewKey.Lines            = Lines;
+	FoundSection.KeyIndex.Add( Key, FoundSection.Keys.Num() - 1 );
+}
+
+void FOmniSyncIniDocument::RemoveKey( const FString& Section, const FString& Key )
+{
+	const int32* SectionIdx = SectionIndex.Find( Section );
+	if( !SectionIdx )
+		return;
+
+	FOmniSyncIniSection& FoundSection = Sections[ *SectionIdx ];
+	const int32*         KeyIndex     = FoundSection.KeyIndex.Find( Key );
+	if( !KeyIndex )
+		return;
+
+	FoundSection.Keys.RemoveAt( *KeyIndex );
+
+	FoundSection.KeyIndex.Reset();
+	for( int32 i = 0; i < FoundSection.Keys.Num(); ++i )
+		FoundSection.KeyIndex.Add( FoundSection.Keys[ i ].Name, i );
+}
+
+FString FOmniSyncIniDocument::GetKeyName( const FString& Line )
+{
+	int32 EqualsIndex = INDEX_NONE;
+	Line.FindChar( TEXT( '=' ), EqualsIndex );
+
+	FString Name = EqualsIndex == INDEX_NONE ? Line : Line.Left( EqualsIndex );
+	Name.TrimStartAndEndInline();
+
+	if( !Name.IsEmpty() && FCString::Strchr( TEXT( "+-.!@*" ), Name[ 0 ] ) )
+		Name.RightChopInline( 1 );
+
+	return Name;
+}
+
+bool FOmniSyncIniDocument::LinesEqual( const TArray< FString >* A, const TArray< FString >* B )
+{
+	if( !A || !B )
+		return A == B;
+
+	if( A->Num() != B->Num() )
+		return false;
+
+	// Values are compared case sensitively, a True/true flip is still a change worth syncing
+	for( int32 i = 0; i < A->Num(); ++i )
+	{
+		if( !( *A )[ i ].Equals( ( *B )[ i ], ESearchCase::CaseSensitive ) )
+			return false;
+	}
+
+	return true;
+}
+
+FOmniSyncIniSection& FOmniSyncIniDocument::FindOrAddSection( const FString& Section )
+{
+	if( const int32* Index = SectionIndex.Find( Section ) )
+		return Sections[ *Index ];
+
+	FOmniSyncIniSection& NewSection = Sections.AddDefaulted_GetRef();
+	NewSection.Name                 = Section;
+	SectionIndex.Add( Section, Sections.Num() - 1 );
+	return NewSection;
+}
+
+TArray< FOmniSyncIniChange > FOmniSyncIniMerge::Merge( const FOmniSyncIniDocument& Base,
+                                                       const FOmniSyncIniDocument& Ours,
+                                                       const FOmniSyncIniDocument& Theirs,
+                                                       const EOmniSyncMergeWinner  ConflictWinner,
+                                                       FOmniSyncIniDocument&       Target )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FOmniSyncIniChange > Changes;
+	TSet< FString >              VisitedKeys;
+
+	auto MergeKey = [&]( const FString& Section, const FString& Key )
+	{
+		bool bAlreadyVisited = false;
+		VisitedKeys.Add( Section + TEXT( "\n" ) + Key, &bAlreadyVisited );
+		if( bAlreadyVisited )
+			return;
+
+		const TArray< FString >* BaseLines   = Base.FindLines( Section, Key );
+		const TArray< FString >* OurLines    = Ours.FindLines( Section, Key );
+		const TArray< FString >* TheirLines  = Theirs.FindLines( Section, Key );
+		const TArray< FString >* MergedLines = nullptr;
+
+		if( FOmniSyncIniDocument::LinesEqual( OurLines, TheirLines ) || FOmniSyncIniDocument::LinesEqual( TheirLines, BaseLines ) )
+			MergedLines = OurLines;
+		else if( FOmniSyncIniDocument::LinesEqual( OurLines, BaseLines ) )
+			MergedLines = TheirLines;
+		else
+			MergedLines = ConflictWinner == EOmniSyncMergeWinner::Ours ? OurLines : TheirLines;
+
+		if( FOmniSyncIniDocument::LinesEqual( MergedLines, Target.FindLines( Section, Key ) ) )
+			return;
+
+		if( MergedLines )
+			Target.SetLines( Section, Key, *MergedLines );
+		else
+			Target.RemoveKey( Section, Key );
+
+		Changes.Add( { Section, Key } );
+	};
+
+	for( const FOmniSyncIniDocument* Document: { &Ours, &Theirs, &Base } )
+	{
+		for( const FOmniSyncIniSection& Section: Document->GetSections() )
+		{
+			for( const FOmniSyncIniKey& Key: Section.Keys )
+				MergeKey( Section.Name, Key.Name );
+		}
+	}
+
+	return Changes;
+}
+
+TArray< FOmniSyncIniChange > FOmniSyncIniMerge::Diff( const FOmniSyncIniDocument& Ours, const FOmniSyncIniDocument& Theirs )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FOmniSyncIniChange > Changes;
+	TSet< FString >              VisitedKeys;
+
+	for( const FOmniSyncIniDocument* Document: { &Ours, &Theirs } )
+	{
+		for( const FOmniSyncIniSection& Section: Document->GetSections() )
+		{
+			for( const FOmniSyncIniKey& Key: Section.Keys )
+			{
+				bool bAlreadyVisited = false;
+				VisitedKeys.Add( Section.Name + TEXT( "\n" ) + Key.Name, &bAlreadyVisited );
+				if( bAlreadyVisited )
+					continue;
+
+				if( !FOmniSyncIniDocument::LinesEqual( Ours.FindLines( Section.Name, Key.Name ), Theirs.FindLines( Section.Name, Key.Name ) ) )
+					Changes.Add( { Section.Name, Key.Name } );
+			}
+		}
+	}
+
+	return Changes;
+}
\ No newline at end of file
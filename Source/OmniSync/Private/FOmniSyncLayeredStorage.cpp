@@ -0,0 +1,190 @@
+#include "FOmniSyncLayeredStorage.h"
+
+#include "FOmniSyncManifest.h"
+#include "FOmniSyncPlan.h"
+#include "Macros.h"
+
+const FOmniSyncLayerCache::FMergedView* FOmniSyncLayerCache::Resolve( IOmniSyncStorage& Store, const EOmniSyncScope TopLayer, const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	const TPair< FString, EOmniSyncScope > Key( RelativePath, TopLayer );
+	const TPair< FString, EOmniSyncScope > LowerKey( RelativePath, static_cast< EOmniSyncScope >( static_cast< uint8 >( TopLayer ) - 1 ) );
+
+	const FMergedView* Lower     = TopLayer != EOmniSyncScope::Global ? Resolve( Store, LowerKey.Value, RelativePath ) : nullptr;
+	const uint64       LowerHash = Lower ? Lower->Hash : 0;
+
+	uint64     LayerHash = 0;
+	const bool bHasLayer = Store.GetHash( TopLayer, RelativePath, LayerHash );
+	if( !Lower && !bHasLayer )
+	{
+		Views.Remove( Key );
+		return nullptr;
+	}
+
+	FMergedView& View = Views.FindOrAdd( Key );
+	if( View.bHasLower == ( Lower != nullptr ) && View.LowerHash == LowerHash && View.bHasLayer == bHasLayer && View.LayerHash == LayerHash )
+		return &View;
+
+	// Adding this view may have moved the one below, so it is looked up again before its document is copied
+	FOmniSyncIniDocument Document;
+	if( Lower )
+		Document = Views.FindChecked( LowerKey ).Document;
+
+	if( bHasLayer )
+	{
+		TArray< uint8 > LayerBytes;
+		if( !Store.Read( TopLayer, RelativePath, LayerBytes ) )
+		{
+			Views.Remove( Key );
+			return nullptr;
+		}
+
+		// The marker is bookkeeping of the store, it never reaches a merged view
+		FString LayerText = UOmniSyncSettings::DecodeIniText( LayerBytes );
+		if( LayerText.StartsWith( OverridesMarker, ESearchCase::CaseSensitive ) )
+			LayerText.Split( TEXT( "\n" ), nullptr, &LayerText );
+
+		FOmniSyncIniDocument LayerDocument;
+		LayerDocument.Parse( LayerText );
+
+		// The lowest layer keeps its comments and ordering, the ones above only replace the lines of the keys they set
+		if( !Lower )
+			Document = MoveTemp( LayerDocument );
+		else
+		{
+			for( const FOmniSyncIniSection& Section: LayerDocument.GetSections() )
+			{
+				for( const FOmniSyncIniKey& Key: Section.Keys )
+					Document.SetLines( Section.Name, Key.Name, Key.Lines );
+			}
+		}
+	}
+
+	View.Bytes     = UOmniSyncSettings::EncodeIniText( Document.ToString() );
+	View.Hash      = FOmniSyncManifest::HashBuffer( View.Bytes.GetData(), View.Bytes.Num() );
+	View.Document  = MoveTemp( Document );
+	View.LowerHash = LowerHash;
+	View.LayerHash = LayerHash;
+	View.bHasLower = Lower != nullptr;
+	View.bHasLayer = bHasLayer;
+	return &View;
+}
+
+bool FOmniSyncLayerCache::IsOverrideLayer( IOmniSyncStorage& Store, const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	uint64 Hash = 0;
+	if( Scope == EOmniSyncScope::Global || !Store.GetHash( Scope, RelativePath, Hash ) )
+		return false;
+
+	// Remembered per content hash, the layer is only read again after it changed
+	const TPair< FString, EOmniSyncScope > Key( RelativePath, Scope );
+	if( const TPair< uint64, bool >* Format = LayerFormats.Find( Key ) )
+	{
+		if( Format->Key == Hash )
+			return Format->Value;
+	}
+
+	TArray< uint8 > Bytes;
+	if( !Store.Read( Scope, RelativePath, Bytes ) )
+		return false;
+
+	static const FTCHARToUTF8 Marker( OverridesMarker );
+	const bool                bOverrides = Bytes.Num() >= Marker.Length() && FMemory::Memcmp( Bytes.GetData(), Marker.Get(), Marker.Length() ) == 0;
+	LayerFormats.Add( Key, { Hash, bOverrides } );
+	return bOverrides;
+}
+
+FOmniSyncLayeredStorage::FOmniSyncLayeredStorage( IOmniSyncStorage& InStore, const FOmniSyncPlan& InPlan, FOmniSyncLayerCache& InCache )
+	: Store( InStore )
+	, Plan( InPlan )
+	, Cache( InCache )
+{}
+
+bool FOmniSyncLayeredStorage::GetHash( const EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !IsStoredAsLayer( Scope, RelativePath ) )
+		return Store.GetHash( Scope, RelativePath, OutHash );
+
+	const FOmniSyncLayerCache::FMergedView* View = Cache.Resolve( Store, Scope, RelativePath );
+	if( !View )
+		return false;
+
+	OutHash = View->Hash;
+	return true;
+}
+
+bool FOmniSyncLayeredStorage::Read( const EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !IsStoredAsLayer( Scope, RelativePath ) )
+		return Store.Read( Scope, RelativePath, OutBytes );
+
+	const FOmniSyncLayerCache::FMergedView* View = Cache.Resolve( Store, Scope, RelativePath );
+	if( !View )
+		return false;
+
+	OutBytes = View->Bytes;
+	return true;
+}
+
+bool FOmniSyncLayeredStorage::Write( const EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, const uint64 Hash )
+{
+	TRACE_CPU_SCOPE;
+
+	// A project that does not layer the file writes it whole again, which every reader takes as the full file from then on
+	if( !IsLayered( Scope, RelativePath ) )
+		return Store.Write( Scope, RelativePath, Bytes, Hash );
+
+	// With nothing below to inherit from, the layer holds the whole file
+	const FOmniSyncLayerCache::FMergedView* Lower = Cache.Resolve( Store, static_cast< EOmniSyncScope >( static_cast< uint8 >( Scope ) - 1 ), RelativePath );
+	if( !Lower )
+		return Store.Write( Scope, RelativePath, Bytes, Hash );
+
+	FOmniSyncIniDocument Document;
+	Document.Parse( UOmniSyncSettings::DecodeIniText( Bytes ) );
+
+	FOmniSyncIniDocument Overrides;
+	for( const FOmniSyncIniSection& Section: Document.GetSections() )
+	{
+		for( const FOmniSyncIniKey& Key: Section.Keys )
+		{
+			if( !FOmniSyncIniDocument::LinesEqual( &Key.Lines, Lower->Document.FindLines( Section.Name, Key.Name ) ) )
+				Overrides.SetLines( Section.Name, Key.Name, Key.Lines );
+		}
+	}
+
+	const TArray< uint8 > OverrideBytes = UOmniSyncSettings::EncodeIniText( FString( FOmniSyncLayerCache::OverridesMarker ) + LINE_TERMINATOR + Overrides.ToString() );
+	return Store.Write( Scope, RelativePath, OverrideBytes, FOmniSyncManifest::HashBuffer( OverrideBytes.GetData(), OverrideBytes.Num() ) );
+}
+
+FString FOmniSyncLayeredStorage::GetPlainFile( const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	// A merged view only exists in memory, there is no file that could be copied as it is
+	return IsStoredAsLayer( Scope, RelativePath ) ? FString() : Store.GetPlainFile( Scope, RelativePath );
+}
+
+bool FOmniSyncLayeredStorage::IsLayered( const EOmniSyncScope Scope, const FString& RelativePath ) const
+{
+	// The global layer is the bottom of every stack, it is stored and read as a whole file
+	if( Scope == EOmniSyncScope::Global )
+		return false;
+
+	const int32 EntryIndex = Plan.Find( UOmniSyncSettings::NormalizeRelativePath( RelativePath ) );
+	if( EntryIndex == INDEX_NONE )
+		return false;
+
+	const FOmniSyncPlanEntry& Entry = Plan.GetEntries()[ EntryIndex ];
+	return Entry.Scope == Scope && EnumHasAnyFlags( Entry.Flags, EOmniSyncPlanFlags::Layered );
+}
+
+bool FOmniSyncLayeredStorage::IsStoredAsLayer( const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	// bLayered is a per-project setting but PerEngineVersion is shared, so the format written into the store decides how a file is read
+	return IsLayered( Scope, RelativePath ) || Cache.IsOverrideLayer( Store, Scope, RelativePath );
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "FOmniSyncManifest.h"
+
+#include "FOmniSync.h"
+#include "FOmniSyncStats.h"
+#include "Hash/xxhash.h"
+#include "JsonObjectConverter.h"
+#include "Macros.h"
+
+namespace
+{
+	// FAT and SMB shares keep two seconds, most POSIX file systems report whole seconds through the engine
+	constexpr double TimestampGranularitySeconds = 2.0;
+}
+
+void FOmniSyncManifest::Load()
+{
+	TRACE_CPU_SCOPE;
+
+	Data.Entries.Empty();
+	DirtyPaths.Empty();
+	bDirty          = false;
+	LoadedTime      = FDateTime::UtcNow();
+	LoadedTimestamp = IFileManager::Get().GetTimeStamp( *FilePath );
+
+	FString JsonString;
+	if( !FFileHelper::LoadFileToString( JsonString, *FilePath ) )
+		return;
+
+	if( !FJsonObjectConverter::JsonObjectStringToUStruct( JsonString, &Data ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Discarding unreadable manifest: %s" ), *FilePath );
+		Data.Entries.Empty();
+	}
+}
+
+bool FOmniSyncManifest::Save()
+{
+	TRACE_CPU_SCOPE;
+
+	if( !bDirty )
+		return true;
+
+	// Shared scopes are written by every project, entries this instance did not touch are taken from the copy on disk. It is read
+	// again whatever its timestamp says, another editor may have saved within the same timestamp second
+	{
+		const FOmniSyncManifestData LocalData  = MoveTemp( Data );
+		TSet< FString >             LocalDirty = MoveTemp( DirtyPaths );
+		Load();
+
+		for( const FString& RelativePath: LocalDirty )
+		{
+			if( const FOmniSyncManifestEntry* Entry = LocalData.Entries.Find( RelativePath ) )
+				Data.Entries.Add( RelativePath, *Entry );
+			else
+				Data.Entries.Remove( RelativePath );
+		}
+
+		// A failed write keeps the entries dirty, the next save merges them again
+		DirtyPaths = MoveTemp( LocalDirty );
+		bDirty     = true;
+	}
+
+	FString OutputString;
+	if( !FJsonObjectConverter::UStructToJsonObjectString( Data, OutputString, 0, 0, 0, nullptr, false ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to convert manifest JSON: %s" ), *FilePath );
+		return false;
+	}
+
+	if( !FFileHelper::SaveStringToFile( OutputString, *FilePath ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to write manifest: %s" ), *FilePath );
+		return false;
+	}
+
+	DirtyPaths.Empty();
+	bDirty          = false;
+	LoadedTime      = FDateTime::UtcNow();
+	LoadedTimestamp = IFileManager::Get().GetTimeStamp( *FilePath );
+	return true;
+}
+
+void FOmniSyncManifest::Refresh()
+{
+	TRACE_CPU_SCOPE;
+
+	if( !bDirty && ( IFileManager::Get().GetTimeStamp( *FilePath ) != LoadedTimestamp || IsRacy( LoadedTimestamp, LoadedTime ) ) )
+		Load();
+}
+
+bool FOmniSyncManifest::GetHash( const FString& RelativePath, const FString& File, uint64& OutHash )
+{
+	TRACE_CPU_SCOPE;
+
+	const FFileStatData StatData = IFileManager::Get().GetStatData( *File );
+	if( !StatData.bIsValid || StatData.bIsDirectory )
+	{
+		if( Data.Entries.Remove( RelativePath ) > 0 )
+			MarkDirty( RelativePath );
+		return false;
+	}
+
+	FOmniSyncManifestEntry& Entry = Data.Entries.FindOrAdd( RelativePath );
+	// An edit that keeps the size within the same timestamp tick as the last hash would look unchanged, such entries are hashed again
+	if( Entry.Size == StatData.FileSize && Entry.Timestamp == StatData.ModificationTime && !Entry.Hash.IsEmpty() && !IsRacy( Entry.Timestamp, Entry.HashTime ) )
+	{
+		OutHash = StringToHash( Entry.Hash );
+		return true;
+	}
+
+	const FDateTime HashTime = FDateTime::UtcNow();
+	if( !HashFile( File, OutHash ) )
+		return false;
+
+	const FString HashText = HashToString( OutHash );
+	if( Entry.Size == StatData.FileSize && Entry.Timestamp == StatData.ModificationTime && Entry.Hash == HashText && IsRacy( Entry.Timestamp, HashTime ) )
+		return true;
+
+	Entry.Size      = StatData.FileSize;
+	Entry.Timestamp = StatData.ModificationTime;
+	Entry.Hash      = HashText;
+	Entry.HashTime  = HashTime;
+	MarkDirty( RelativePath );
+	return true;
+}
+
+void FOmniSyncManifest::Update( const FString& RelativePath, const FString& File, const uint64 Hash )
+{
+	TRACE_CPU_SCOPE;
+
+	const FFileStatData StatData = IFileManager::Get().GetStatData( *File );
+	if( !StatData.bIsValid )
+		return;
+
+	FOmniSyncManifestEntry& Entry = Data.Entries.FindOrAdd( RelativePath );
+	Entry.Size                    = StatData.FileSize;
+	Entry.Timestamp               = StatData.ModificationTime;
+	Entry.Hash                    = HashToString( Hash );
+	Entry.HashTime                = FDateTime::UtcNow();
+	MarkDirty( RelativePath );
+}
+
+void FOmniSyncManifest::Set( const FString& RelativePath, const FOmniSyncManifestEntry& Entry )
+{
+	TRACE_CPU_SCOPE;
+
+	Data.Entries.Add( RelativePath, Entry );
+	MarkDirty( RelativePath );
+}
+
+void FOmniSyncManifest::SetSyncState( const FString& RelativePath, const int64 Generation, const uint64 Hash )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncManifestEntry& Entry = Data.Entries.FindOrAdd( RelativePath );
+	const FString           Text  = HashToString( Hash );
+	if( Entry.SyncedGeneration == Generation && Entry.SyncedHash == Text )
+		return;
+
+	Entry.SyncedGeneration = Generation;
+	Entry.SyncedHash       = Text;
+	MarkDirty( RelativePath );
+}
+
+void FOmniSyncManifest::ForgetSyncedHash( const FString& RelativePath, const int64 Generation )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncManifestEntry& Entry = Data.Entries.FindOrAdd( RelativePath );
+	Entry.SyncedGeneration        = Generation;
+	Entry.SyncedHash.Empty();
+	MarkDirty( RelativePath );
+}
+
+bool FOmniSyncManifest::HashFile( const FString& File, uint64& OutHash )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray64< uint8 > Bytes;
+	if( !FFileHelper::LoadFileToArray( Bytes, *File ) )
+		return false;
+
+	OutHash = HashBuffer( Bytes.GetData(), Bytes.Num() );
+	FOmniSyncStats::AddFileHashed();
+	return true;
+}
+
+bool FOmniSyncManifest::IsRacy( const FDateTime& Timestamp, const FDateTime& ReadTime )
+{
+	return ( ReadTime - Timestamp ).GetTotalSeconds() < TimestampGranularitySeconds;
+}
+
+uint64 FOmniSyncManifest::HashBuffer( const void* Buffer, const int64 Size )
+{
+	TRACE_CPU_SCOPE;
+	return FXxHash64::HashBuffer( Buffer, Size ).Hash;
+}
+
+void FOmniSyncManifest::MarkDirty( const FString& RelativePath )
+{
+	DirtyPaths.Add( RelativePath );
+	bDirty = true;
+}
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "FOmniSyncPackStorage.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "FOmniSync.h"
+#include "FOmniSyncManifest.h"
+#include "Macros.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 PackMagic   = 0x3150534F; // "OSP1"
+	constexpr uint32 PackVersion = 1;
+
+	bool PathLess( const FString& A, const FString& B )
+	{
+		return A.Compare( B, ESearchCase::CaseSensitive ) < 0;
+	}
+}
+
+const FOmniSyncPackStorage::FEntry* FOmniSyncPackStorage::FPack::Find( const FString& RelativePath ) const
+{
+	const int32 Index = Algo::BinarySearchBy( Entries, RelativePath, &FEntry::RelativePath, &PathLess );
+	return Entries.IsValidIndex( Index ) ? &Entries[ Index ] : nullptr;
+}
+
+void FOmniSyncPackStorage::FPack::Unmap()
+{
+	Region.Reset();
+	Handle.Reset();
+}
+
+FOmniSyncPackStorage::FOmniSyncPackStorage() = default;
+
+FOmniSyncPackStorage::~FOmniSyncPackStorage() = default;
+
+bool FOmniSyncPackStorage::GetHash( const EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash )
+{
+	TRACE_CPU_SCOPE;
+
+	FPack& Pack = GetPack( Scope );
+	if( const FPendingFile* PendingFile = Pack.Pending.Find( RelativePath ) )
+	{
+		OutHash = PendingFile->Hash;
+		return true;
+	}
+
+	Refresh( Pack );
+
+	const FEntry* Entry = Pack.Find( RelativePath );
+	if( !Entry )
+		return false;
+
+	OutHash = Entry->Hash;
+	return true;
+}
+
+bool FOmniSyncPackStorage::Read( const EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes )
+{
+	TRACE_CPU_SCOPE;
+
+	FPack& Pack = GetPack( Scope );
+	if( const FPendingFile* PendingFile = Pack.Pending.Find( RelativePath ) )
+	{
+		OutBytes = PendingFile->Bytes;
+		return true;
+	}
+
+	if( !Refresh( Pack ) || ( !Pack.Region.IsValid() && !Map( Pack ) ) )
+		return false;
+
+	const FEntry* Entry = Pack.Find( RelativePath );
+	if( !Entry )
+		return false;
+
+	OutBytes.SetNumUninitialized( Entry->Size );
+	FMemory::Memcpy( OutBytes.GetData(), Pack.Region->GetMappedPtr() + Entry->Offset, Entry->Size );
+	return true;
+}
+
+bool FOmniSyncPackStorage::Write( const EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, const uint64 Hash )
+{
+	TRACE_CPU_SCOPE;
+
+	// Writes are held until the end of the batch and then land in the pack with a single sequential write
+	FPendingFile& PendingFile = GetPack( Scope ).Pending.FindOrAdd( RelativePath );
+	PendingFile.Hash          = Hash;
+	PendingFile.Bytes         = Bytes;
+	return true;
+}
+
+bool FOmniSyncPackStorage::Flush()
+{
+	TRACE_CPU_SCOPE;
+
+	bool bWritten = true;
+	for( const TPair< EOmniSyncScope, TUniquePtr< FPack > >& Pair: Packs )
+	{
+		FPack& Pack = *Pair.Value;
+
+		// Lost writes are dropped rather than kept for the next batch, they would land there without a generation bump of their own
+		if( !Pack.Pending.IsEmpty() && !WritePack( Pack ) )
+		{
+			UE_LOG( OmniSync, Error, TEXT( "Failed to write pack %s, %d files were not stored" ), *Pack.File, Pack.Pending.Num() );
+			Pack.Pending.Empty();
+			bWritten = false;
+		}
+
+		// Mappings are released between batches, otherwise other editors could not replace the pack on Windows
+		Pack.Unmap();
+	}
+
+	return bWritten;
+}
+
+TArray< FString > FOmniSyncPackStorage::GetRelativePaths( const EOmniSyncScope Scope )
+{
+	TRACE_CPU_SCOPE;
+
+	FPack& Pack = GetPack( Scope );
+	Refresh( Pack );
+
+	TArray< FString > RelativePaths;
+	Pack.Pending.GetKeys( RelativePaths );
+
+	for( const FEntry& Entry: Pack.Entries )
+	{
+		if( !Pack.Pending.Contains( Entry.RelativePath ) )
+			RelativePaths.Add( Entry.RelativePath );
+	}
+
+	return RelativePaths;
+}
+
+FString FOmniSyncPackStorage::GetPackPath( const EOmniSyncScope Scope )
+{
+	return FPaths::Combine( UOmniSyncSettings::GetScopedSettingsDirectory( Scope ), "OmniSyncPack.bin" );
+}
+
+FOmniSyncPackStorage::FPack& FOmniSyncPackStorage::GetPack( const EOmniSyncScope Scope )
+{
+	TUniquePtr< FPack >& Pack = Packs.FindOrAdd( Scope );
+	if( !Pack.IsValid() )
+	{
+		Pack       = MakeUnique< FPack >();
+		Pack->File = GetPackPath( Scope );
+	}
+
+	return *Pack;
+}
+
+bool FOmniSyncPackStorage::Map( FPack& Pack )
+{
+	TRACE_CPU_SCOPE;
+
+	Pack.Unmap();
+	Pack.Entries.Empty();
+
+	// A failed read leaves the timestamp unset, so the next access retries instead of treating the scope as empty
+	const FDateTime Timestamp = IFileManager::Get().GetTimeStamp( *Pack.File );
+	Pack.Timestamp            = FDateTime::MinValue();
+	Pack.LoadedTime           = FDateTime::UtcNow();
+
+	if( Timestamp == FDateTime::MinValue() )
+		return true;
+
+	FOpenMappedResult Result = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx( *Pack.File );
+	if( Result.HasError() )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to map pack %s" ), *Pack.File );
+		return false;
+	}
+
+	Pack.Handle = Result.StealValue();
+	Pack.Region.Reset( Pack.Handle->MapRegion( 0, Pack.Handle->GetFileSize() ) );
+	if( !Pack.Region.IsValid() )
+	{
+		Pack.Unmap();
+		return false;
+	}
+
+	const int64       DataSize = Pack.Region->GetMappedSize();
+	FMemoryReaderView Reader( TArrayView64< const uint8 >( Pack.Region->GetMappedPtr(), DataSize ) );
+
+	uint32 Magic       = 0;
+	uint32 Version     = 0;
+	int32  Count       = 0;
+	int64  IndexOffset = 0;
+	Reader << Magic << Version << Count << IndexOffset;
+
+	if( Reader.IsError() || Magic != PackMagic || Version != PackVersion || Count < 0 || IndexOffset < Reader.Tell() || IndexOffset > DataSize || Count > DataSize - IndexOffset )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Ignoring unreadable pack %s" ), *Pack.File );
+		Pack.Unmap();
+		return false;
+	}
+
+	Reader.Seek( IndexOffset );
+	Pack.Entries.SetNum( Count );
+	for( FEntry& Entry: Pack.Entries )
+	{
+		Reader << Entry.RelativePath << Entry.Hash << Entry.Offset << Entry.Size;
+		if( Reader.IsError() || Entry.Offset < 0 || Entry.Size < 0 || Entry.Offset + Entry.Size > IndexOffset )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Ignoring unreadable pack %s" ), *Pack.File );
+			Pack.Entries.Empty();
+			Pack.Unmap();
+			return false;
+		}
+	}
+
+	Pack.Timestamp = Timestamp;
+	return true;
+}
+
+bool FOmniSyncPackStorage::Refresh( FPack& Pack )
+{
+	// Another editor may have rewritten the pack since the index was read, even within the same timestamp tick
+	if( IFileManager::Get().GetTimeStamp( *Pack.File ) == Pack.Timestamp && !FOmniSyncManifest::IsRacy( Pack.Timestamp, Pack.LoadedTime ) )
+		return true;
+
+	return Map( Pack );
+}
+
+bool FOmniSyncPackStorage::WritePack( FPack& Pack )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !Refresh( Pack ) || ( !Pack.Entries.IsEmpty() && !Pack.Region.IsValid() && !Map( Pack ) ) )
+		return false;
+
+	TArray< FString > RelativePaths;
+	Pack.Pending.GetKeys( RelativePaths );
+	for( const FEntry& Entry: Pack.Entries )
+	{
+		if( !Pack.Pending.Contains( Entry.RelativePath ) )
+			RelativePaths.Add( Entry.RelativePath );
+	}
+
+	RelativePaths.Sort( &PathLess );
+
+	uint32 Magic       = PackMagic;
+	uint32 Version     = PackVersion;
+	int32  Count       = RelativePaths.Num();
+	int64  IndexOffset = 0;
+
+	TArray64< uint8 > Buffer;
+	FMemoryWriter64   Writer( Buffer );
+	Writer << Magic << Version << Count << IndexOffset;
+
+	TArray< FEntry > Entries;
+	Entries.Reserve( Count );
+	for( const FString& RelativePath: RelativePaths )
+	{
+		FEntry& Entry      = Entries.AddDefaulted_GetRef();
+		Entry.RelativePath = RelativePath;
+		Entry.Offset       = Writer.Tell();
+
+		if( const FPendingFile* PendingFile = Pack.Pending.Find( RelativePath ) )
+		{
+			Entry.Hash = PendingFile->Hash;
+			Entry.Size = PendingFile->Bytes.Num();
+			Writer.Serialize( const_cast< uint8* >( PendingFile->Bytes.GetData() ), Entry.Size );
+		}
+		else
+		{
+			const FEntry* Existing = Pack.Find( RelativePath );
+			Entry.Hash             = Existing->Hash;
+			Entry.Size             = Existing->Size;
+			Writer.Serialize( const_cast< uint8* >( Pack.Region->GetMappedPtr() + Existing->Offset ), Entry.Size );
+		}
+	}
+
+	IndexOffset = Writer.Tell();
+	for( FEntry& Entry: Entries )
+		Writer << Entry.RelativePath << Entry.Hash << Entry.Offset << Entry.Size;
+
+	Writer.Seek( 0 );
+	Writer << Magic << Version << Count << IndexOffset;
+
+	// The old pack has to be unmapped before it can be replaced
+	Pack.Unmap();
+
+	// Editors that sync the same scope without its lock must not write into each other's temporary file
+	const FString TempFile = FString::Printf( TEXT( "%s.%s.tmp" ), *Pack.File, *FGuid::NewGuid().ToString() );
+	if( !FFileHelper::SaveArrayToFile( Buffer, *TempFile ) || !IFileManager::Get().Move( *Pack.File, *TempFile ) )
+	{
+		IFileManager::Get().Delete( *TempFile );
+		return false;
+	}
+
+	Pack.Entries    = MoveTemp( Entries );
+	Pack.LoadedTime = FDateTime::UtcNow();
+	Pack.Timestamp  = IFileManager::Get().GetTimeStamp( *Pack.File );
+	Pack.Pending.Empty();
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "FOmniSyncPathRules.h"
+
+#include "Macros.h"
+
+TSharedRef< const FOmniSyncPathRules > FOmniSyncPathRules::Compile( const TArray< FString >& ExcludePatterns, const TArray< FString >& IncludePatterns )
+{
+	TRACE_CPU_SCOPE;
+
+	const TSharedRef< FOmniSyncPathRules > Rules = MakeShared< FOmniSyncPathRules >();
+	for( const FString& Pattern: ExcludePatterns )
+		Rules->Excludes.Add( Pattern );
+
+	for( const FString& Pattern: IncludePatterns )
+		Rules->Includes.Add( Pattern );
+
+	return Rules;
+}
+
+bool FOmniSyncPathRules::IsExcluded( const FStringView RelativePath ) const
+{
+	if( Excludes.IsEmpty() )
+		return false;
+
+	TArray< FStringView, TInlineAllocator< 16 > > Segments;
+	SplitPath( RelativePath, Segments );
+
+	return Excludes.MatchesSelfOrParent( RelativePath, Segments ) && !Includes.MatchesSelfOrParent( RelativePath, Segments );
+}
+
+bool FOmniSyncPathRules::ShouldPruneDirectory( const FStringView RelativeDirectory ) const
+{
+	if( Excludes.IsEmpty() )
+		return false;
+
+	TArray< FStringView, TInlineAllocator< 16 > > Segments;
+	SplitPath( RelativeDirectory, Segments );
+
+	return Excludes.MatchesSelfOrParent( RelativeDirectory, Segments ) && !Includes.CouldMatchBelow( RelativeDirectory, Segments );
+}
+
+uint32 FOmniSyncPathRules::FPathKeyFuncs::GetKeyHash( const FStringView Key )
+{
+	uint32 Hash = 0;
+	for( const TCHAR Char: Key )
+		Hash = HashCombineFast( Hash, FChar::ToLower( Char ) );
+
+	return Hash;
+}
+
+bool FOmniSyncPathRules::FSegment::Matches( const FStringView Name ) const
+{
+	return bWildcard ? MatchesWildcard( Name, Text ) : Name.Equals( Text, ESearchCase::IgnoreCase );
+}
+
+void FOmniSyncPathRules::FRuleSet::Add( const FString& Pattern )
+{
+	FString Normalized = Pattern.TrimStartAndEnd().Replace( TEXT( "\\" ), TEXT( "/" ) );
+	while( Normalized.StartsWith( TEXT( "./" ) ) )
+		Normalized.RightChopInline( 2 );
+
+	Normalized.TrimCharInline( TEXT( '/' ), nullptr );
+	if( Normalized.IsEmpty() )
+		return;
+
+	const bool bHasSlash    = Normalized.Contains( TEXT( "/" ) );
+	const bool bHasWildcard = Normalized.Contains( TEXT( "*" ) ) || Normalized.Contains( TEXT( "?" ) );
+	if( !bHasWildcard )
+	{
+		( bHasSlash ? Paths : Names ).Add( MoveTemp( Normalized ) );
+		return;
+	}
+
+	// Like in .gitignore, a pattern without a slash matches a name at any depth
+	TArray< FSegment >& Glob = Globs.AddDefaulted_GetRef();
+	if( !bHasSlash )
+		Glob.Add( { FString(), true, false } );
+
+	TArray< FString > Parts;
+	Normalized.ParseIntoArray( Parts, TEXT( "/" ) );
+	for( FString& Part: Parts )
+	{
+		const bool bAnyDepth = Part == TEXT( "**" );
+		const bool bWildcard = !bAnyDepth && ( Part.Contains( TEXT( "*" ) ) || Part.Contains( TEXT( "?" ) ) );
+		Glob.Add( { MoveTemp( Part ), bAnyDepth, bWildcard } );
+	}
+}
+
+bool FOmniSyncPathRules::FRuleSet::MatchesSelfOrParent( const FStringView Path, const TConstArrayView< FStringView > Segments ) const
+{
+	for( const FStringView Segment: Segments )
+	{
+		if( !Names.IsEmpty() && Names.ContainsByHash( FPathKeyFuncs::GetKeyHash( Segment ), Segment ) )
+			return true;
+
+		// Every prefix that ends on a segment boundary is the path of a parent directory, or of the path itself
+		const FStringView Prefix = Path.Left( static_cast< int32 >( Segment.GetData() - Path.GetData() ) + Segment.Len() );
+		if( !Paths.IsEmpty() && Paths.ContainsByHash( FPathKeyFuncs::GetKeyHash( Prefix ), Prefix ) )
+			return true;
+	}
+
+	for( const TArray< FSegment >& Glob: Globs )
+	{
+		if( MatchSegments( Glob, Segments, false ) )
+			return true;
+	}
+
+	return false;
+}
+
+bool FOmniSyncPathRules::FRuleSet::CouldMatchBelow( const FStringView Directory, const TConstArrayView< FStringView > Segments ) const
+{
+	// A name can turn up at any depth, so a directory is only pruned when no plain name is included at all
+	if( !Names.IsEmpty() || MatchesSelfOrParent( Directory, Segments ) )
+		return true;
+
+	if( !Paths.IsEmpty() )
+	{
+		FString Prefix;
+		for( const FStringView Segment: Segments )
+		{
+			Prefix.Append( Segment.GetData(), Segment.Len() );
+			Prefix.AppendChar( TEXT( '/' ) );
+		}
+
+		for( const FString& IncludedPath: Paths )
+		{
+			if( IncludedPath.StartsWith( Prefix ) )
+				return true;
+		}
+	}
+
+	for( const TArray< FSegment >& Glob: Globs )
+	{
+		if( MatchSegments( Glob, Segments, true ) )
+			return true;
+	}
+
+	return false;
+}
+
+bool FOmniSyncPathRules::MatchesWildcard( const FStringView Name, const FStringView Pattern )
+{
+	// Greedy with one backtrack point, a later star makes backtracking to an earlier one unnecessary
+	int32 NameIndex     = 0;
+	int32 PatternIndex  = 0;
+	int32 StarIndex     = INDEX_NONE;
+	int32 StarNameIndex = 0;
+	while( NameIndex < Name.Len() )
+	{
+		if( PatternIndex < Pattern.Len() && Pattern[ PatternIndex ] == TEXT( '*' ) )
+		{
+			StarIndex     = PatternIndex++;
+			StarNameIndex = NameIndex;
+		}
+		else if( PatternIndex < Pattern.Len() && ( Pattern[ PatternIndex ] == TEXT( '?' ) || FChar::ToLower( Pattern[ PatternIndex ] ) == FChar::ToLower( Name[ NameIndex ] ) ) )
+		{
+			PatternIndex++;
+			NameIndex++;
+		}
+		else if( StarIndex != INDEX_NONE )
+		{
+			PatternIndex = StarIndex + 1;
+			NameIndex    = ++StarNameIndex;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	while( PatternIndex < Pattern.Len() && Pattern[ PatternIndex ] == TEXT( '*' ) )
+		PatternIndex++;
+
+	return PatternIndex == Pattern.Len();
+}
+
+bool FOmniSyncPathRules::MatchSegments( const TConstArrayView< FSegment > Pattern, const TConstArrayView< FStringView > Path, const bool bPathMayContinue )
+{
+	// Running out of pattern first means it matched a parent directory, which covers everything below it
+	if( Pattern.IsEmpty() )
+		return true;
+
+	if( Pattern[ 0 ].bAnyDepth )
+		return MatchSegments( Pattern.RightChop( 1 ), Path, bPathMayContinue ) || ( !Path.IsEmpty() && MatchSegments( Pattern, Path.RightChop( 1 ), bPathMayContinue ) );
+
+	// Running out of path first only matches when asking whether something below the directory could match
+	if( Path.IsEmpty() )
+		return bPathMayContinue;
+
+	return Pattern[ 0 ].Matches( Path[ 0 ] ) && MatchSegments( Pattern.RightChop( 1 ), Path.RightChop( 1 ), bPathMayContinue );
+}
+
+void FOmniSyncPathRules::SplitPath( const FStringView Path, TArray< FStringView, TInlineAllocator< 16 > >& OutSegments )
+{
+	int32 Start = 0;
+	for( int32 Index = 0; Index <= Path.Len(); ++Index )
+	{
+		if( Index < Path.Len() && Path[ Index ] != TEXT( '/' ) && Path[ Index ] != TEXT( '\\' ) )
+			continue;
+
+		if( Index > Start )
+			OutSegments.Add( Path.Mid( Start, Index - Start ) );
+
+		Start = Index + 1;
+	}
+}
\ No newline at end of file
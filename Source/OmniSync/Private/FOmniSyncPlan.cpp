@@ -0,0 +1,49 @@
+#include "FOmniSyncPlan.h"
+
+#include "FOmniSyncPathRules.h"
+#include "Macros.h"
+
+TSharedRef< const FOmniSyncPlan > FOmniSyncPlan::Build( const TArray< FConfigFileSettings >& Settings, const FOmniSyncPathRules& Rules )
+{
+	TRACE_CPU_SCOPE;
+
+	static const FString ProjectDir = FPaths::ProjectDir();
+
+	const TSharedRef< FOmniSyncPlan > Plan = MakeShared< FOmniSyncPlan >();
+	for( const FConfigFileSettings& Setting: Settings )
+	{
+		// Excluded files drop out here, so no job, watcher event or verify ever looks at them
+		if( !Setting.bEnabled || Rules.IsExcluded( Setting.RelativePath ) )
+			continue;
+
+		FOmniSyncPlanEntry& Entry = Plan->Entries.AddDefaulted_GetRef();
+		Entry.RelativePath        = Setting.RelativePath;
+		Entry.LocalFile           = FPaths::Combine( ProjectDir, Setting.RelativePath );
+		Entry.BaseFile            = UOmniSyncSettings::GetBaseFilePath( Setting.SettingsScope, Setting.RelativePath );
+		Entry.Scope               = Setting.SettingsScope;
+
+		if( Setting.bAutoSyncEnabled )
+		{
+			Entry.Flags |= EOmniSyncPlanFlags::AutoSync;
+			Plan->NumAutoSync++;
+		}
+
+		if( Setting.bLayered )
+			Entry.Flags |= EOmniSyncPlanFlags::Layered;
+
+		Plan->EntryIndex.Add( UOmniSyncSettings::NormalizeRelativePath( Setting.RelativePath ), Plan->Entries.Num() - 1 );
+	}
+
+	return Plan;
+}
+
+int32 FOmniSyncPlan::Num( const EOmniSyncPlanFlags Flags ) const
+{
+	return EnumHasAnyFlags( Flags, EOmniSyncPlanFlags::AutoSync ) ? NumAutoSync : Entries.Num();
+}
+
+int32 FOmniSyncPlan::Find( const FString& NormalizedRelativePath ) const
+{
+	const int32* Index = EntryIndex.Find( NormalizedRelativePath );
+	return Index ? *Index : INDEX_NONE;
+}
\ No newline at end of file
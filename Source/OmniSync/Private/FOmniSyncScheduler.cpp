@@ -0,0 +1,135 @@
+#include "FOmniSyncScheduler.h"
+
+#include "Macros.h"
+
+void FOmniSyncScheduler::FPendingEvent::Touch( const double Now )
+{
+	if( FirstTime == 0.0 )
+		FirstTime = Now;
+	LastTime = Now;
+}
+
+bool FOmniSyncScheduler::FPendingEvent::IsSettled( const double Now, const float QuietWindow, const float MaxDelay ) const
+{
+	// A file that keeps getting written still flushes once it has waited for MaxDelay in total
+	return Now - LastTime >= QuietWindow || Now - FirstTime >= MaxDelay;
+}
+
+FOmniSyncScheduler::FOmniSyncScheduler( const FOnSyncBatchReady& InOnBatchReady )
+	: OnBatchReady( InOnBatchReady )
+{}
+
+FOmniSyncScheduler::~FOmniSyncScheduler()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker( TickHandle );
+}
+
+void FOmniSyncScheduler::ScheduleFile( const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	PendingFiles.FindOrAdd( RelativePath ).Touch( FPlatformTime::Seconds() );
+	EnsureTicking();
+}
+
+void FOmniSyncScheduler::ScheduleAllFiles()
+{
+	TRACE_CPU_SCOPE;
+
+	if( !AllFiles.IsSet() )
+		AllFiles.Emplace();
+
+	AllFiles->Touch( FPlatformTime::Seconds() );
+	EnsureTicking();
+}
+
+void FOmniSyncScheduler::ScheduleSettingsSave()
+{
+	TRACE_CPU_SCOPE;
+
+	if( !SettingsSave.IsSet() )
+		SettingsSave.Emplace();
+
+	SettingsSave->Touch( FPlatformTime::Seconds() );
+	EnsureTicking();
+}
+
+void FOmniSyncScheduler::Flush()
+{
+	TRACE_CPU_SCOPE;
+
+	if( !HasPending() )
+		return;
+
+	FOmniSyncBatch Batch;
+	Batch.bAllFiles     = AllFiles.IsSet();
+	Batch.bSaveSettings = SettingsSave.IsSet();
+
+	if( !Batch.bAllFiles )
+		PendingFiles.GetKeys( Batch.Files );
+
+	Batch.FirstChangeTime = AllFiles.IsSet() ? AllFiles->FirstTime : 0.0;
+	for( const TPair< FString, FPendingEvent >& PendingFile: PendingFiles )
+		Batch.FirstChangeTime = Batch.FirstChangeTime > 0.0 ? FMath::Min( Batch.FirstChangeTime, PendingFile.Value.FirstTime ) : PendingFile.Value.FirstTime;
+
+	PendingFiles.Empty();
+	AllFiles.Reset();
+	SettingsSave.Reset();
+
+	OnBatchReady.ExecuteIfBound( Batch );
+}
+
+bool FOmniSyncScheduler::Tick( const float DeltaTime )
+{
+	TRACE_CPU_SCOPE;
+
+	const double   Now = FPlatformTime::Seconds();
+	FOmniSyncBatch Batch;
+
+	if( SettingsSave.IsSet() && SettingsSave->IsSettled( Now, QuietWindow, MaxDelay ) )
+	{
+		Batch.bSaveSettings = true;
+		SettingsSave.Reset();
+	}
+
+	// A pending full sync already covers every single file, so those are folded into it instead of being queued twice
+	if( AllFiles.IsSet() )
+	{
+		if( AllFiles->IsSettled( Now, QuietWindow, MaxDelay ) )
+		{
+			Batch.bAllFiles       = true;
+			Batch.FirstChangeTime = AllFiles->FirstTime;
+			AllFiles.Reset();
+			PendingFiles.Empty();
+		}
+	}
+	else
+	{
+		for( auto It = PendingFiles.CreateIterator(); It; ++It )
+		{
+			if( !It->Value.IsSettled( Now, QuietWindow, MaxDelay ) )
+				continue;
+
+			Batch.Files.Add( It->Key );
+			Batch.FirstChangeTime = Batch.FirstChangeTime > 0.0 ? FMath::Min( Batch.FirstChangeTime, It->Value.FirstTime ) : It->Value.FirstTime;
+			It.RemoveCurrent();
+		}
+	}
+
+	if( !Batch.IsEmpty() )
+		OnBatchReady.ExecuteIfBound( Batch );
+
+	if( HasPending() )
+		return true;
+
+	TickHandle.Reset();
+	return false;
+}
+
+void FOmniSyncScheduler::EnsureTicking()
+{
+	if( TickHandle.IsValid() )
+		return;
+
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker( FTickerDelegate::CreateRaw( this, &FOmniSyncScheduler::Tick ), 0.1f );
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "FOmniSyncSearchIndex.h"
+
+#include "Macros.h"
+
+void FOmniSyncSearchIndex::Reset( const TArray< FString >& InPaths )
+{
+	TRACE_CPU_SCOPE;
+
+	Paths.Reset( InPaths.Num() );
+	for( const FString& Path: InPaths )
+		Paths.Add( Path.ToLower() );
+
+	Trigrams.Empty();
+	bTrigramsBuilt = false;
+
+	LastQuery.Empty();
+	LastMatches.Empty();
+}
+
+const TArray< int32 >& FOmniSyncSearchIndex::Query( const FString& Text )
+{
+	TRACE_CPU_SCOPE;
+
+	const FString Needle = Text.ToLower();
+	if( Needle == LastQuery && !LastQuery.IsEmpty() )
+		return LastMatches;
+
+	// Typing only ever narrows the previous result, so those matches are the only candidates left
+	TArray< int32 > Candidates;
+	if( !LastQuery.IsEmpty() && Needle.Contains( LastQuery, ESearchCase::CaseSensitive ) )
+	{
+		Candidates = MoveTemp( LastMatches );
+	}
+	else if( Needle.Len() >= 3 )
+	{
+		BuildTrigrams();
+
+		// Every match contains each trigram of the needle, the rarest one gives the shortest list to verify
+		const TArray< int32 >* Shortest = nullptr;
+		for( int32 Index = 0; Index + 3 <= Needle.Len(); ++Index )
+		{
+			const TArray< int32 >* Postings = Trigrams.Find( GetTrigramKey( *Needle + Index ) );
+			if( !Postings )
+			{
+				LastQuery = Needle;
+				LastMatches.Empty();
+				return LastMatches;
+			}
+
+			if( !Shortest || Postings->Num() < Shortest->Num() )
+				Shortest = Postings;
+		}
+
+		Candidates = *Shortest;
+	}
+	else
+	{
+		Candidates.Reserve( Paths.Num() );
+		for( int32 Index = 0; Index < Paths.Num(); ++Index )
+			Candidates.Add( Index );
+	}
+
+	LastMatches.Reset();
+	for( const int32 Index: Candidates )
+	{
+		if( Paths[ Index ].Contains( Needle, ESearchCase::CaseSensitive ) )
+			LastMatches.Add( Index );
+	}
+
+	LastQuery = Needle;
+	return LastMatches;
+}
+
+uint64 FOmniSyncSearchIndex::GetTrigramKey( const TCHAR* Chars )
+{
+	return static_cast< uint64 >( Chars[ 0 ] & 0xFFFF ) << 32 | static_cast< uint64 >( Chars[ 1 ] & 0xFFFF ) << 16 | static_cast< uint64 >( Chars[ 2 ] & 0xFFFF );
+}
+
+void FOmniSyncSearchIndex::BuildTrigrams()
+{
+	TRACE_CPU_SCOPE;
+
+	if( bTrigramsBuilt )
+		return;
+
+	for( int32 PathIndex = 0; PathIndex < Paths.Num(); ++PathIndex )
+	{
+		const FString& Path = Paths[ PathIndex ];
+		for( int32 Index = 0; Index + 3 <= Path.Len(); ++Index )
+		{
+			// Postings stay sorted because the paths are visited in order, a repeated trigram only checks the tail
+			TArray< int32 >& Postings = Trigrams.FindOrAdd( GetTrigramKey( *Path + Index ) );
+			if( Postings.IsEmpty() || Postings.Last() != PathIndex )
+				Postings.Add( PathIndex );
+		}
+	}
+
+	bTrigramsBuilt = true;
+}
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include "FOmniSyncSettingsStore.h"
+
+#include "FOmniSync.h"
+#include "JsonObjectConverter.h"
+#include "Macros.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 SnapshotMagic   = 0x3153534F; // "OSS1"
+	constexpr uint32 JournalMagic    = 0x314A534F; // "OSJ1"
+	constexpr uint32 SettingsVersion = 4;
+
+	enum class ERecordType : uint8
+	{
+		Entry,
+		Remove,
+		Options,
+	};
+
+	enum EEntryFlags : uint8
+	{
+		EntryEnabled  = 1 << 0,
+		EntryAutoSync = 1 << 1,
+		EntryLayered  = 1 << 2,
+	};
+
+	void ExportSettings( const TArray< FString >& Args )
+	{
+		UOmniSyncSettings::Get()->ExportSettingsJson( Args.IsEmpty() ? FString() : Args[ 0 ] );
+	}
+
+	void ImportSettings( const TArray< FString >& Args )
+	{
+		UOmniSyncSettings::Get()->ImportSettingsJson( Args.IsEmpty() ? FString() : Args[ 0 ] );
+	}
+
+	FAutoConsoleCommand ExportSettingsCommand( TEXT( "OmniSync.ExportSettings" ),
+	                                           TEXT( "Writes the plugin settings as JSON, by default to OmniSyncSettings.json. Usage: OmniSync.ExportSettings [File]" ),
+	                                           FConsoleCommandWithArgsDelegate::CreateStatic( &ExportSettings ) );
+
+	FAutoConsoleCommand ImportSettingsCommand( TEXT( "OmniSync.ImportSettings" ),
+	                                           TEXT( "Replaces the plugin settings with a JSON export, by default OmniSyncSettings.json. Usage: OmniSync.ImportSettings [File]" ),
+	                                           FConsoleCommandWithArgsDelegate::CreateStatic( &ImportSettings ) );
+}
+
+FOmniSyncSettingsStore::FOmniSyncSettingsStore( const FString& InDirectory )
+	: SnapshotFile( FPaths::Combine( InDirectory, "OmniSyncSettings.bin" ) )
+	, JournalFile( FPaths::Combine( InDirectory, "OmniSyncSettings.journal" ) )
+{}
+
+bool FOmniSyncSettingsStore::Load( FConfigFileSettingsStruct& OutSettings, int32& OutJournalRecords )
+{
+	TRACE_CPU_SCOPE;
+
+	OutJournalRecords = 0;
+	bNeedsCompaction  = false;
+
+	TArray< uint8 > Snapshot;
+	if( !FFileHelper::LoadFileToArray( Snapshot, *SnapshotFile, FILEREAD_Silent ) )
+		return false;
+
+	FMemoryReader Reader( Snapshot );
+
+	uint32 Magic   = 0;
+	uint32 Version = 0;
+	int32  Count   = 0;
+	Reader << Magic << Version << Generation;
+
+	FConfigFileSettingsStruct Settings;
+	if( !Reader.IsError() && Magic == SnapshotMagic && Version <= SettingsVersion )
+	{
+		SerializeOptions( Reader, Version, Settings );
+		Reader << Count;
+	}
+
+	if( Reader.IsError() || Magic != SnapshotMagic || Version > SettingsVersion || Count < 0 || Count > Snapshot.Num() )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Ignoring unreadable settings snapshot: %s" ), *SnapshotFile );
+		return false;
+	}
+
+	Settings.Settings.SetNum( Count );
+	for( FConfigFileSettings& Setting: Settings.Settings )
+		SerializeEntry( Reader, Setting );
+
+	if( Reader.IsError() )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Ignoring truncated settings snapshot: %s" ), *SnapshotFile );
+		return false;
+	}
+
+	// A journal left behind by an interrupted compaction belongs to the previous snapshot and is started over
+	TArray< uint8 > Journal;
+	if( FFileHelper::LoadFileToArray( Journal, *JournalFile, FILEREAD_Silent ) )
+		bResetJournal = !ApplyJournal( Journal, Settings, OutJournalRecords );
+
+	OutSettings = MoveTemp( Settings );
+	return true;
+}
+
+TArray< uint8 > FOmniSyncSettingsStore::MakeSnapshot( const FConfigFileSettingsStruct& Settings )
+{
+	TRACE_CPU_SCOPE;
+
+	FConfigFileSettingsStruct& MutableSettings = const_cast< FConfigFileSettingsStruct& >( Settings );
+	int32                      Count           = Settings.Settings.Num();
+
+	TArray< uint8 > Bytes;
+	FMemoryWriter   Writer( Bytes );
+	SerializeOptions( Writer, SettingsVersion, MutableSettings );
+	Writer << Count;
+
+	for( FConfigFileSettings& Setting: MutableSettings.Settings )
+		SerializeEntry( Writer, Setting );
+
+	return Bytes;
+}
+
+void FOmniSyncSettingsStore::AddEntryRecord( TArray< uint8 >& Records, const FConfigFileSettings& Setting )
+{
+	AddRecord( Records, static_cast< uint8 >( ERecordType::Entry ), [&Setting]( FArchive& Archive )
+	{
+		SerializeEntry( Archive, const_cast< FConfigFileSettings& >( Setting ) );
+	} );
+}
+
+void FOmniSyncSettingsStore::AddRemoveRecord( TArray< uint8 >& Records, const FString& RelativePath )
+{
+	AddRecord( Records, static_cast< uint8 >( ERecordType::Remove ), [&RelativePath]( FArchive& Archive )
+	{
+		Archive << const_cast< FString& >( RelativePath );
+	} );
+}
+
+void FOmniSyncSettingsStore::AddOptionsRecord( TArray< uint8 >& Records, const FConfigFileSettingsStruct& Settings )
+{
+	AddRecord( Records, static_cast< uint8 >( ERecordType::Options ), [&Settings]( FArchive& Archive )
+	{
+		SerializeOptions( Archive, SettingsVersion, const_cast< FConfigFileSettingsStruct& >( Settings ) );
+	} );
+}
+
+bool FOmniSyncSettingsStore::WriteSnapshot( const TArray< uint8 >& Snapshot )
+{
+	TRACE_CPU_SCOPE;
+
+	uint32 Magic          = SnapshotMagic;
+	uint32 Version        = SettingsVersion;
+	uint32 NextGeneration = Generation + 1;
+
+	TArray< uint8 > Bytes;
+	FMemoryWriter   Writer( Bytes );
+	Writer << Magic << Version << NextGeneration;
+	Writer.Serialize( const_cast< uint8* >( Snapshot.GetData() ), Snapshot.Num() );
+
+	const FString TempFile = SnapshotFile + TEXT( ".tmp" );
+	if( !FFileHelper::SaveArrayToFile( Bytes, *TempFile ) || !IFileManager::Get().Move( *SnapshotFile, *TempFile ) )
+	{
+		IFileManager::Get().Delete( *TempFile );
+		UE_LOG( OmniSync, Error, TEXT( "Failed to write settings snapshot: %s" ), *SnapshotFile );
+		return false;
+	}
+
+	// The journal is only read when its generation matches, so a failed delete cannot replay old records
+	Generation       = NextGeneration;
+	bResetJournal    = true;
+	bNeedsCompaction = false;
+	IFileManager::Get().Delete( *JournalFile, false, false, true );
+	return true;
+}
+
+bool FOmniSyncSettingsStore::AppendJournal( const TArray< uint8 >& Records )
+{
+	TRACE_CPU_SCOPE;
+
+	const bool bNewJournal = bResetJournal || IFileManager::Get().FileSize( *JournalFile ) <= 0;
+
+	// Records are parsed with the version in the journal header and replay stops at a torn record, so neither journal can be appended to
+	if( !bNewJournal && bNeedsCompaction )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Settings journal has an older format or a torn record and needs a new snapshot: %s" ), *JournalFile );
+		return false;
+	}
+
+	TUniquePtr< FArchive > Writer( IFileManager::Get().CreateFileWriter( *JournalFile, bNewJournal ? 0 : FILEWRITE_Append ) );
+	if( !Writer.IsValid() )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to open settings journal: %s" ), *JournalFile );
+		return false;
+	}
+
+	if( bNewJournal )
+	{
+		uint32 Magic   = JournalMagic;
+		uint32 Version = SettingsVersion;
+		*Writer << Magic << Version << Generation;
+	}
+
+	Writer->Serialize( const_cast< uint8* >( Records.GetData() ), Records.Num() );
+	if( !Writer->Close() )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to append to settings journal: %s" ), *JournalFile );
+		return false;
+	}
+
+	bResetJournal    = false;
+	bNeedsCompaction = false;
+	return true;
+}
+
+bool FOmniSyncSettingsStore::ExportJson( const FConfigFileSettingsStruct& Settings, const FString& File )
+{
+	TRACE_CPU_SCOPE;
+
+	FString OutputString;
+	if( !FJsonObjectConverter::UStructToJsonObjectString( Settings, OutputString, 0, 0, 0, nullptr, true ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to convert settings JSON: %s" ), *File );
+		return false;
+	}
+
+	if( !FFileHelper::SaveStringToFile( OutputString, *File ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to write settings file: %s" ), *File );
+		return false;
+	}
+
+	UE_LOG( OmniSync, Log, TEXT( "Plugin settings exported to: %s" ), *File );
+	return true;
+}
+
+bool FOmniSyncSettingsStore::ImportJson( const FString& File, FConfigFileSettingsStruct& OutSettings )
+{
+	TRACE_CPU_SCOPE;
+
+	FString JsonString;
+	if( !FFileHelper::LoadFileToString( JsonString, *File ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to read settings file: %s" ), *File );
+		return false;
+	}
+
+	FConfigFileSettingsStruct Settings;
+	if( !FJsonObjectConverter::JsonObjectStringToUStruct( JsonString, &Settings ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "Failed to convert settings JSON: %s" ), *File );
+		return false;
+	}
+
+	OutSettings = MoveTemp( Settings );
+	UE_LOG( OmniSync, Log, TEXT( "Plugin settings imported from: %s" ), *File );
+	return true;
+}
+
+void FOmniSyncSettingsStore::SerializeOptions( FArchive& Archive, const uint32 Version, FConfigFileSettingsStruct& Settings )
+{
+	Archive << Settings.bHotApplyOnLoad;
+	Archive << Settings.SyncQuietWindowSeconds;
+	Archive << Settings.SyncMaxDelaySeconds;
+	Archive << Settings.StorageMode;
+	Archive << Settings.bCompressBlobs;
+
+	if( Version >= 2 )
+		Archive << Settings.bAutoPull;
+
+	if( Version >= 3 )
+		Archive << Settings.ExcludePaths << Settings.IncludePaths;
+
+	if( Version >= 4 )
+		Archive << Settings.HistoryMaxVersions << Settings.HistoryMaxKilobytes;
+}
+
+void FOmniSyncSettingsStore::SerializeEntry( FArchive& Archive, FConfigFileSettings& Setting )
+{
+	uint8 Flags = ( Setting.bEnabled ? EntryEnabled : 0 ) | ( Setting.bAutoSyncEnabled ? EntryAutoSync : 0 ) | ( Setting.bLayered ? EntryLayered : 0 );
+	uint8 Scope = static_cast< uint8 >( Setting.SettingsScope );
+	Archive << Setting.RelativePath << Flags << Scope;
+
+	if( !Archive.IsLoading() )
+		return;
+
+	Setting.FileName         = FPaths::GetCleanFilename( Setting.RelativePath );
+	Setting.bEnabled         = ( Flags & EntryEnabled ) != 0;
+	Setting.bAutoSyncEnabled = ( Flags & EntryAutoSync ) != 0;
+	Setting.bLayered         = ( Flags & EntryLayered ) != 0;
+	Setting.SettingsScope    = static_cast< EOmniSyncScope >( FMath::Min( Scope, static_cast< uint8 >( EOmniSyncScope::PerProject ) ) );
+}
+
+void FOmniSyncSettingsStore::AddRecord( TArray< uint8 >& Records, uint8 Type, const TFunctionRef< void( FArchive& ) > Serialize )
+{
+	TArray< uint8 > Payload;
+	FMemoryWriter   PayloadWriter( Payload );
+	Serialize( PayloadWriter );
+
+	int32         Size = Payload.Num();
+	FMemoryWriter Writer( Records, false, true );
+	Writer << Type << Size;
+	Writer.Serialize( Payload.GetData(), Size );
+}
+
+bool FOmniSyncSettingsStore::ApplyJournal( const TArray< uint8 >& Journal, FConfigFileSettingsStruct& Settings, int32& OutJournalRecords )
+{
+	TRACE_CPU_SCOPE;
+
+	FMemoryReader Reader( Journal );
+
+	uint32 Magic             = 0;
+	uint32 Version           = 0;
+	uint32 JournalGeneration = 0;
+	Reader << Magic << Version << JournalGeneration;
+
+	if( Reader.IsError() || Magic != JournalMagic || Version > SettingsVersion || JournalGeneration != Generation )
+		return false;
+
+	bNeedsCompaction = Version != SettingsVersion;
+
+	TMap< FString, int32 > SettingsIndex;
+	for( int32 Index = 0; Index < Settings.Settings.Num(); ++Index )
+		SettingsIndex.Add( UOmniSyncSettings::NormalizeRelativePath( Settings.Settings[ Index ].RelativePath ), Index );
+
+	while( Reader.Tell() < Reader.TotalSize() )
+	{
+		uint8 Type = 0;
+		int32 Size = 0;
+		Reader << Type << Size;
+
+		// A record cut off by a crash ends the journal, everything before it is intact. Records appended after it would be misread,
+		// so the next save has to start from a fresh snapshot
+		if( Reader.IsError() || Size < 0 || Reader.Tell() + Size > Reader.TotalSize() )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Settings journal ends in a torn record, replayed %d records: %s" ), OutJournalRecords, *JournalFile );
+			bNeedsCompaction = true;
+			break;
+		}
+
+		const int64 RecordEnd = Reader.Tell() + Size;
+		switch( static_cast< ERecordType >( Type ) )
+		{
+			case ERecordType::Entry:
+			{
+				FConfigFileSettings Setting;
+				SerializeEntry( Reader, Setting );
+
+				FString NormalizedPath = UOmniSyncSettings::NormalizeRelativePath( Setting.RelativePath );
+				if( const int32* Index = SettingsIndex.Find( NormalizedPath ) )
+				{
+					Settings.Settings[ *Index ] = MoveTemp( Setting );
+				}
+				else
+				{
+					SettingsIndex.Add( MoveTemp( NormalizedPath ), Settings.Settings.Num() );
+					Settings.Settings.Add( MoveTemp( Setting ) );
+				}
+				break;
+			}
+			case ERecordType::Remove:
+			{
+				FString RelativePath;
+				Reader << RelativePath;
+
+				int32 Index = INDEX_NONE;
+				if( SettingsIndex.RemoveAndCopyValue( UOmniSyncSettings::NormalizeRelativePath( RelativePath ), Index ) )
+				{
+					Settings.Settings.RemoveAtSwap( Index );
+					if( Settings.Settings.IsValidIndex( Index ) )
+						SettingsIndex.Add( UOmniSyncSettings::NormalizeRelativePath( Settings.Settings[ Index ].RelativePath ), Index );
+				}
+				break;
+			}
+			case ERecordType::Options:
+				SerializeOptions( Reader, Version, Settings );
+				break;
+			default:
+				break;
+		}
+
+		Reader.Seek( RecordEnd );
+		OutJournalRecords++;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "FOmniSyncStats.h"
+
+#include "FOmniSync.h"
+#include "Macros.h"
+
+#define LOCTEXT_NAMESPACE "FOmniSyncStats"
+
+DEFINE_STAT( STAT_OmniSyncFilesScanned );
+DEFINE_STAT( STAT_OmniSyncFilesHashed );
+DEFINE_STAT( STAT_OmniSyncFilesCopied );
+DEFINE_STAT( STAT_OmniSyncFilesSkipped );
+DEFINE_STAT( STAT_OmniSyncBytesWritten );
+DEFINE_STAT( STAT_OmniSyncPendingJobs );
+
+UE_TRACE_CHANNEL_DEFINE( OmniSyncChannel );
+
+std::atomic< uint64 >     FOmniSyncStats::FilesScanned = 0;
+std::atomic< uint64 >     FOmniSyncStats::FilesHashed  = 0;
+std::atomic< uint64 >     FOmniSyncStats::FilesCopied  = 0;
+std::atomic< uint64 >     FOmniSyncStats::FilesSkipped = 0;
+std::atomic< uint64 >     FOmniSyncStats::BytesWritten = 0;
+std::atomic< int32 >      FOmniSyncStats::PendingJobs  = 0;
+std::atomic< uint32 >     FOmniSyncStats::Version      = 0;
+FOmniSyncLatencyHistogram FOmniSyncStats::Histograms[ static_cast< int32 >( EOmniSyncOperation::Num ) ];
+
+namespace
+{
+	void DumpStats( const TArray< FString >& Args )
+	{
+		if( !Args.IsEmpty() && Args[ 0 ] == TEXT( "Reset" ) )
+			FOmniSyncStats::Reset();
+		else
+			FOmniSyncStats::Dump();
+	}
+
+	FAutoConsoleCommand StatsCommand( TEXT( "OmniSync.Stats" ),
+	                                  TEXT( "Logs the OmniSync counters and latency histograms. Usage: OmniSync.Stats [Reset]" ),
+	                                  FConsoleCommandWithArgsDelegate::CreateStatic( &DumpStats ) );
+
+	FString FormatMilliseconds( const double Seconds )
+	{
+		return FString::Printf( TEXT( "%.1f ms" ), Seconds * 1000.0 );
+	}
+}
+
+const TCHAR* LexToString( const EOmniSyncOperation Operation )
+{
+	switch( Operation )
+	{
+		case EOmniSyncOperation::Discover:
+			return TEXT( "Discover" );
+		case EOmniSyncOperation::Push:
+			return TEXT( "Push" );
+		case EOmniSyncOperation::Pull:
+			return TEXT( "Pull" );
+		case EOmniSyncOperation::Verify:
+			return TEXT( "Verify" );
+		case EOmniSyncOperation::Job:
+			return TEXT( "Job" );
+		default:
+			return TEXT( "ChangeToStore" );
+	}
+}
+
+void FOmniSyncLatencyHistogram::Add( const double Seconds )
+{
+	const uint64 Microseconds = static_cast< uint64 >( FMath::Max( Seconds, 0.0 ) * 1e6 );
+	const int32  Bucket       = FMath::Min( static_cast< int32 >( FMath::FloorLog2_64( Microseconds ) ), NumBuckets - 1 );
+
+	Buckets[ Bucket ].fetch_add( 1, std::memory_order_relaxed );
+	Count.fetch_add( 1, std::memory_order_relaxed );
+	TotalMicroseconds.fetch_add( Microseconds, std::memory_order_relaxed );
+
+	uint64 Max = MaxMicroseconds.load( std::memory_order_relaxed );
+	while( Microseconds > Max && !MaxMicroseconds.compare_exchange_weak( Max, Microseconds, std::memory_order_relaxed ) )
+	{}
+}
+
+void FOmniSyncLatencyHistogram::Reset()
+{
+	for( std::atomic< uint64 >& Bucket: Buckets )
+		Bucket.store( 0, std::memory_order_relaxed );
+
+	Count.store( 0, std::memory_order_relaxed );
+	TotalMicroseconds.store( 0, std::memory_order_relaxed );
+	MaxMicroseconds.store( 0, std::memory_order_relaxed );
+}
+
+double FOmniSyncLatencyHistogram::GetPercentile( const double Percentile ) const
+{
+	const uint64 Total = Num();
+	if( Total == 0 )
+		return 0.0;
+
+	// Reported as the upper bound of the bucket the rank falls into, capped by the largest sample seen
+	const uint64 Rank       = FMath::Max< uint64 >( static_cast< uint64 >( FMath::CeilToDouble( Percentile * static_cast< double >( Total ) ) ), 1 );
+	uint64       Cumulative = 0;
+	for( int32 Bucket = 0; Bucket < NumBuckets; ++Bucket )
+	{
+		Cumulative += GetBucket( Bucket );
+		if( Cumulative >= Rank )
+			return FMath::Min( GetBucketUpperBound( Bucket ), GetMax() );
+	}
+
+	return GetMax();
+}
+
+double FOmniSyncLatencyHistogram::GetMean() const
+{
+	const uint64 Total = Num();
+	return Total ? static_cast< double >( TotalMicroseconds.load( std::memory_order_relaxed ) ) * 1e-6 / static_cast< double >( Total ) : 0.0;
+}
+
+double FOmniSyncLatencyHistogram::GetBucketUpperBound( const int32 Bucket )
+{
+	return static_cast< double >( uint64( 1 ) << ( Bucket + 1 ) ) * 1e-6;
+}
+
+void FOmniSyncStats::AddFilesScanned( const int32 Count )
+{
+	INC_DWORD_STAT_BY( STAT_OmniSyncFilesScanned, Count );
+	FilesScanned.fetch_add( Count, std::memory_order_relaxed );
+	MarkChanged();
+}
+
+void FOmniSyncStats::AddFileHashed()
+{
+	INC_DWORD_STAT( STAT_OmniSyncFilesHashed );
+	FilesHashed.fetch_add( 1, std::memory_order_relaxed );
+	MarkChanged();
+}
+
+void FOmniSyncStats::AddFileCopied()
+{
+	INC_DWORD_STAT( STAT_OmniSyncFilesCopied );
+	FilesCopied.fetch_add( 1, std::memory_order_relaxed );
+	MarkChanged();
+}
+
+void FOmniSyncStats::AddFileSkipped()
+{
+	INC_DWORD_STAT( STAT_OmniSyncFilesSkipped );
+	FilesSkipped.fetch_add( 1, std::memory_order_relaxed );
+	MarkChanged();
+}
+
+void FOmniSyncStats::AddBytesWritten( const int64 Bytes )
+{
+	INC_DWORD_STAT_BY( STAT_OmniSyncBytesWritten, Bytes );
+	BytesWritten.fetch_add( Bytes, std::memory_order_relaxed );
+	MarkChanged();
+}
+
+void FOmniSyncStats::AddPendingJobs( const int32 Delta )
+{
+	SET_DWORD_STAT( STAT_OmniSyncPendingJobs, PendingJobs.fetch_add( Delta, std::memory_order_relaxed ) + Delta );
+	MarkChanged();
+}
+
+void FOmniSyncStats::RecordLatency( const EOmniSyncOperation Operation, const double Seconds )
+{
+	Histograms[ static_cast< int32 >( Operation ) ].Add( Seconds );
+	MarkChanged();
+}
+
+const FOmniSyncLatencyHistogram& FOmniSyncStats::GetHistogram( const EOmniSyncOperation Operation )
+{
+	return Histograms[ static_cast< int32 >( Operation ) ];
+}
+
+FText FOmniSyncStats::GetStatusText()
+{
+	check( IsInGameThread() );
+
+	// The panel polls this every frame, the text is only formatted again after a counter moved
+	static FText  CachedText;
+	static uint32 CachedVersion = MAX_uint32;
+
+	const uint32 CurrentVersion = Version.load( std::memory_order_relaxed );
+	if( CurrentVersion == CachedVersion )
+		return CachedText;
+
+	const FOmniSyncLatencyHistogram& Push          = GetHistogram( EOmniSyncOperation::Push );
+	const FOmniSyncLatencyHistogram& ChangeToStore = GetHistogram( EOmniSyncOperation::ChangeToStore );
+
+	FFormatNamedArguments Arguments;
+	Arguments.Add( TEXT( "Scanned" ), FText::AsNumber( FilesScanned.load( std::memory_order_relaxed ) ) );
+	Arguments.Add( TEXT( "Hashed" ), FText::AsNumber( FilesHashed.load( std::memory_order_relaxed ) ) );
+	Arguments.Add( TEXT( "Copied" ), FText::AsNumber( FilesCopied.load( std::memory_order_relaxed ) ) );
+	Arguments.Add( TEXT( "Skipped" ), FText::AsNumber( FilesSkipped.load( std::memory_order_relaxed ) ) );
+	Arguments.Add( TEXT( "Written" ), FText::AsMemory( BytesWritten.load( std::memory_order_relaxed ) ) );
+	Arguments.Add( TEXT( "PushMedian" ), FText::FromString( FormatMilliseconds( Push.GetPercentile( 0.5 ) ) ) );
+	Arguments.Add( TEXT( "PushP95" ), FText::FromString( FormatMilliseconds( Push.GetPercentile( 0.95 ) ) ) );
+	Arguments.Add( TEXT( "ChangeP95" ), FText::FromString( FormatMilliseconds( ChangeToStore.GetPercentile( 0.95 ) ) ) );
+	Arguments.Add( TEXT( "Pending" ), FText::AsNumber( FMath::Max( PendingJobs.load( std::memory_order_relaxed ), 0 ) ) );
+
+	CachedText    = FText::Format( LOCTEXT( "StatusText",
+	                                        "Scanned {Scanned}  Hashed {Hashed}  Copied {Copied}  Skipped {Skipped}  Written {Written}  |  "
+	                                        "Push p50 {PushMedian} p95 {PushP95}  Change to store p95 {ChangeP95}  |  {Pending} jobs pending" ),
+	                               Arguments );
+	CachedVersion = CurrentVersion;
+	return CachedText;
+}
+
+void FOmniSyncStats::Dump()
+{
+	TRACE_CPU_SCOPE;
+
+	UE_LOG( OmniSync,
+	        Display,
+	        TEXT( "Scanned %llu  Hashed %llu  Copied %llu  Skipped %llu  Written %llu bytes  Pending jobs %d" ),
+	        FilesScanned.load(),
+	        FilesHashed.load(),
+	        FilesCopied.load(),
+	        FilesSkipped.load(),
+	        BytesWritten.load(),
+	        PendingJobs.load() );
+
+	for( int32 Index = 0; Index < static_cast< int32 >( EOmniSyncOperation::Num ); ++Index )
+	{
+		const FOmniSyncLatencyHistogram& Histogram = Histograms[ Index ];
+		if( Histogram.Num() == 0 )
+			continue;
+
+		UE_LOG( OmniSync,
+		        Display,
+		        TEXT( "%-14s count %6llu  mean %s  p50 %s  p95 %s  p99 %s  max %s" ),
+		        LexToString( static_cast< EOmniSyncOperation >( Index ) ),
+		        Histogram.Num(),
+		        *FormatMilliseconds( Histogram.GetMean() ),
+		        *FormatMilliseconds( Histogram.GetPercentile( 0.5 ) ),
+		        *FormatMilliseconds( Histogram.GetPercentile( 0.95 ) ),
+		        *FormatMilliseconds( Histogram.GetPercentile( 0.99 ) ),
+		        *FormatMilliseconds( Histogram.GetMax() ) );
+
+		for( int32 Bucket = 0; Bucket < FOmniSyncLatencyHistogram::NumBuckets; ++Bucket )
+		{
+			if( const uint64 Samples = Histogram.GetBucket( Bucket ) )
+				UE_LOG( OmniSync, Display, TEXT( "    < %12s  %llu" ), *FormatMilliseconds( FOmniSyncLatencyHistogram::GetBucketUpperBound( Bucket ) ), Samples );
+		}
+	}
+}
+
+void FOmniSyncStats::Reset()
+{
+	TRACE_CPU_SCOPE;
+
+	// Pending jobs is a live gauge rather than a running total, so it survives the reset
+	FilesScanned = 0;
+	FilesHashed  = 0;
+	FilesCopied  = 0;
+	FilesSkipped = 0;
+	BytesWritten = 0;
+
+	for( FOmniSyncLatencyHistogram& Histogram: Histograms )
+		Histogram.Reset();
+
+	MarkChanged();
+}
+
+#undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "FOmniSyncBenchmark.h"
+#include "FOmniSyncSettingsStore.h"
+#include "Misc/AutomationTest.h"
+#include "UOmniSyncSettings.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr EAutomationTestFlags TestFlags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter;
+
+	FString LoadText( const FString& File )
+	{
+		FString Text;
+		FFileHelper::LoadFileToString( Text, *File );
+		return Text;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOmniSyncDiscoveryTest, "OmniSync.Discovery.FindsEveryFile", TestFlags )
+
+bool FOmniSyncDiscoveryTest::RunTest( const FString& Parameters )
+{
+	FOmniSyncSandbox Sandbox( 40 );
+	Sandbox.Discover();
+	Sandbox.WaitUntilIdle();
+
+	UOmniSyncSettings& Settings = Sandbox.GetSettings();
+	TestEqual( TEXT( "Discovered files" ), Settings.ConfigFileSettingsStruct.Settings.Num(), Sandbox.GetNumFiles() );
+
+	for( int32 Index = 0; Index < Sandbox.GetNumFiles(); ++Index )
+		TestNotNull( *FString::Printf( TEXT( "Entry for %s" ), *Sandbox.GetRelativePath( Index ) ), Settings.FindSetting( Sandbox.GetRelativePath( Index ) ) );
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOmniSyncDedupTest, "OmniSync.Discovery.AddsEachFileOnce", TestFlags )
+
+bool FOmniSyncDedupTest::RunTest( const FString& Parameters )
+{
+	FOmniSyncSandbox Sandbox( 40 );
+	Sandbox.Discover();
+	Sandbox.Discover();
+	Sandbox.WaitUntilIdle();
+
+	UOmniSyncSettings& Settings = Sandbox.GetSettings();
+	TestEqual( TEXT( "Entries after discovering twice" ), Settings.ConfigFileSettingsStruct.Settings.Num(), Sandbox.GetNumFiles() );
+
+	// The same file spelled with other separators or another case is still the same entry
+	const FString        RelativePath = Sandbox.GetRelativePath( 0 );
+	FConfigFileSettings* Setting      = Settings.FindSetting( RelativePath );
+	TestTrue( TEXT( "Backslash path finds the entry" ), Setting && &Settings.AddSetting( RelativePath.Replace( TEXT( "/" ), TEXT( "\\" ) ) ) == Setting );
+	TestTrue( TEXT( "Upper case path finds the entry" ), Setting && Settings.FindSetting( RelativePath.ToUpper() ) == Setting );
+	TestEqual( TEXT( "Entries after adding known paths" ), Settings.ConfigFileSettingsStruct.Settings.Num(), Sandbox.GetNumFiles() );
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOmniSyncRoundTripTest, "OmniSync.Sync.PushThenPull", TestFlags )
+
+bool FOmniSyncRoundTripTest::RunTest( const FString& Parameters )
+{
+	FOmniSyncSandbox Sandbox( 10 );
+	Sandbox.Discover();
+	Sandbox.EnableAll();
+	Sandbox.Push();
+
+	const FString StoreDir = UOmniSyncSettings::GetScopedSettingsDirectory( EOmniSyncScope::PerEngineVersion );
+	TestTrue( TEXT( "Store is below the sandbox" ), FPaths::IsUnderDirectory( StoreDir, FPaths::ConvertRelativePathToFull( Sandbox.GetRoot() ) ) );
+
+	for( int32 Index = 0; Index < Sandbox.GetNumFiles(); ++Index )
+	{
+		const FString StoreFile = FPaths::Combine( StoreDir, Sandbox.GetRelativePath( Index ) );
+		TestEqual( *FString::Printf( TEXT( "Pushed %s" ), *Sandbox.GetRelativePath( Index ) ), LoadText( StoreFile ), LoadText( Sandbox.GetLocalFile( Index ) ) );
+	}
+
+	// Another editor changing a key in the store is merged into the unchanged project copy
+	const FString StoreFile = FPaths::Combine( StoreDir, Sandbox.GetRelativePath( 0 ) );
+	FFileHelper::SaveStringToFile( LoadText( StoreFile ).Replace( TEXT( "Key0=Value0_0" ), TEXT( "Key0=ChangedInStore" ) ), *StoreFile );
+	Sandbox.Pull();
+	TestTrue( TEXT( "Pulled store edit" ), LoadText( Sandbox.GetLocalFile( 0 ) ).Contains( TEXT( "Key0=ChangedInStore" ) ) );
+
+	// A project file that went missing comes back from the store
+	IFileManager::Get().Delete( *Sandbox.GetLocalFile( 1 ) );
+	Sandbox.Pull();
+	TestEqual( TEXT( "Restored deleted file" ), LoadText( Sandbox.GetLocalFile( 1 ) ), LoadText( FPaths::Combine( StoreDir, Sandbox.GetRelativePath( 1 ) ) ) );
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOmniSyncJournalTest, "OmniSync.Settings.ReplaysJournal", TestFlags )
+
+bool FOmniSyncJournalTest::RunTest( const FString& Parameters )
+{
+	const FString Directory = FPaths::Combine( FPaths::ProjectSavedDir(), TEXT( "OmniSyncTests" ), FGuid::NewGuid().ToString() );
+
+	FConfigFileSettingsStruct Settings;
+	for( int32 Index = 0; Index < 3; ++Index )
+	{
+		FConfigFileSettings& Setting = Settings.Settings.AddDefaulted_GetRef();
+		Setting.RelativePath         = FString::Printf( TEXT( "Config/DefaultTest%d.ini" ), Index );
+		Setting.FileName             = FPaths::GetCleanFilename( Setting.RelativePath );
+	}
+
+	FOmniSyncSettingsStore Store( Directory );
+	TestTrue( TEXT( "Wrote snapshot" ), Store.WriteSnapshot( FOmniSyncSettingsStore::MakeSnapshot( Settings ) ) );
+
+	FConfigFileSettings Enabled = Settings.Settings[ 1 ];
+	Enabled.bEnabled            = true;
+	Enabled.SettingsScope       = EOmniSyncScope::PerProject;
+	Settings.StorageMode        = EOmniSyncStorageMode::Packed;
+
+	TArray< uint8 > Records;
+	FOmniSyncSettingsStore::AddEntryRecord( Records, Enabled );
+	FOmniSyncSettingsStore::AddRemoveRecord( Records, Settings.Settings[ 0 ].RelativePath );
+	FOmniSyncSettingsStore::AddOptionsRecord( Records, Settings );
+	TestTrue( TEXT( "Appended records" ), Store.AppendJournal( Records ) );
+
+	FConfigFileSettingsStruct Loaded;
+	int32                     JournalRecords = 0;
+	FOmniSyncSettingsStore    Reloaded( Directory );
+	TestTrue( TEXT( "Loaded snapshot" ), Reloaded.Load( Loaded, JournalRecords ) );
+	TestEqual( TEXT( "Replayed records" ), JournalRecords, 3 );
+	TestEqual( TEXT( "Entries after removal" ), Loaded.Settings.Num(), 2 );
+	TestTrue( TEXT( "Storage mode from options record" ), Loaded.StorageMode == EOmniSyncStorageMode::Packed );
+	TestFalse( TEXT( "Intact journal needs no compaction" ), Reloaded.NeedsCompaction() );
+
+	const FConfigFileSettings* LoadedEntry = Loaded.Settings.FindByPredicate( [&]( const FConfigFileSettings& Setting ) { return Setting.RelativePath == Enabled.RelativePath; } );
+	TestTrue( TEXT( "Entry record applied" ), LoadedEntry && LoadedEntry->bEnabled && LoadedEntry->SettingsScope == EOmniSyncScope::PerProject );
+
+	// A record header claiming more bytes than follow is what a crash mid-append leaves behind
+	TArray< uint8 > Journal;
+	FFileHelper::LoadFileToArray( Journal, *FPaths::Combine( Directory, TEXT( "OmniSyncSettings.journal" ) ) );
+	Journal.Append( { 0, 0xFF, 0xFF, 0, 0, 1, 2 } );
+	FFileHelper::SaveArrayToFile( Journal, *FPaths::Combine( Directory, TEXT( "OmniSyncSettings.journal" ) ) );
+
+	FOmniSyncSettingsStore Torn( Directory );
+	TestTrue( TEXT( "Loaded torn journal" ), Torn.Load( Loaded, JournalRecords ) );
+	TestEqual( TEXT( "Records before the torn one" ), JournalRecords, 3 );
+	TestTrue( TEXT( "Torn journal needs compaction" ), Torn.NeedsCompaction() );
+	TestFalse( TEXT( "Torn journal refuses appends" ), Torn.AppendJournal( Records ) );
+
+	IFileManager::Get().DeleteDirectory( *Directory, false, true );
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOmniSyncBenchmarkTest, "OmniSync.Benchmark.NoRegressions", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter )
+
+bool FOmniSyncBenchmarkTest::RunTest( const FString& Parameters )
+{
+	const TArray< FOmniSyncBenchmarkResult > Results = FOmniSyncBenchmark::Run( { 10, 1000 }, 3 );
+	for( const FOmniSyncBenchmarkResult& Result: Results )
+		TestEqual( *FString::Printf( TEXT( "Samples of %s with %d files" ), *Result.Operation, Result.NumFiles ), Result.SamplesMs.Num(), Result.MemorySamplesBytes.Num() );
+
+	TestTrue( TEXT( "Sync operations were measured" ), Results.ContainsByPredicate( []( const FOmniSyncBenchmarkResult& Result ) { return Result.Operation == TEXT( "SaveSettingsToGlobal" ); } ) );
+
+	// The first run on a machine records the baseline, later runs fail on anything that got slower than it by the tolerance
+	const FString                          BaselineFile = FOmniSyncBenchmark::GetDefaultBaselineFile();
+	TArray< FOmniSyncBenchmarkRegression > Regressions;
+	if( !FOmniSyncBenchmark::FindRegressions( Results, BaselineFile, 1.5, Regressions ) )
+	{
+		TestTrue( TEXT( "Wrote baseline" ), FOmniSyncBenchmark::WriteJson( Results, 3, BaselineFile ) );
+		AddInfo( FString::Printf( TEXT( "No baseline yet, recorded this run as %s" ), *BaselineFile ) );
+		return true;
+	}
+
+	for( const FOmniSyncBenchmarkRegression& Regression: Regressions )
+	{
+		AddError( FString::Printf( TEXT( "%s with %d files took %.3f ms, the baseline median is %.3f ms" ),
+		                           *Regression.Operation,
+		                           Regression.NumFiles,
+		                           Regression.MedianMs,
+		                           Regression.BaselineMedianMs ) );
+	}
+
+	return true;
+}
+
+#endif
\ No newline at end of file
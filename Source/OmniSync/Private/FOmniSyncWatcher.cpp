@@ -0,0 +1,97 @@
+#include "FOmniSyncWatcher.h"
+
+#include "DirectoryWatcherModule.h"
+#include "FOmniSync.h"
+#include "FOmniSyncGenerations.h"
+#include "IDirectoryWatcher.h"
+#include "Macros.h"
+
+FOmniSyncWatcher::FOmniSyncWatcher( const FOnWatchedFilesChanged& InOnFilesChanged )
+	: OnFilesChanged( InOnFilesChanged )
+{}
+
+FOmniSyncWatcher::~FOmniSyncWatcher()
+{
+	UnwatchAll();
+}
+
+bool FOmniSyncWatcher::Watch( const FString& Directory )
+{
+	TRACE_CPU_SCOPE;
+
+	const FString FullDirectory = FPaths::ConvertRelativePathToFull( Directory );
+	if( WatchedDirectories.Contains( FullDirectory ) )
+		return true;
+
+	if( !FPlatformFileManager::Get().GetPlatformFile().DirectoryExists( *FullDirectory ) )
+		return false;
+
+	FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked< FDirectoryWatcherModule >( "DirectoryWatcher" );
+	IDirectoryWatcher*       DirectoryWatcher       = DirectoryWatcherModule.Get();
+	if( !DirectoryWatcher )
+		return false;
+
+	FDelegateHandle Handle;
+	if( !DirectoryWatcher->RegisterDirectoryChangedCallback_Handle( FullDirectory,
+	                                                                IDirectoryWatcher::FDirectoryChanged::CreateRaw( this, &FOmniSyncWatcher::OnDirectoryChanged ),
+	                                                                Handle ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to watch directory: %s" ), *FullDirectory );
+		return false;
+	}
+
+	WatchedDirectories.Add( FullDirectory, Handle );
+	return true;
+}
+
+void FOmniSyncWatcher::UnwatchAll()
+{
+	TRACE_CPU_SCOPE;
+
+	if( WatchedDirectories.IsEmpty() )
+		return;
+
+	if( FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr< FDirectoryWatcherModule >( "DirectoryWatcher" ) )
+	{
+		if( IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get() )
+		{
+			for( const TPair< FString, FDelegateHandle >& Pair: WatchedDirectories )
+				DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle( Pair.Key, Pair.Value );
+		}
+	}
+
+	WatchedDirectories.Empty();
+}
+
+bool FOmniSyncWatcher::ConsumeRescanRequest()
+{
+	const bool bWasRequested = bRescanRequested;
+	bRescanRequested         = false;
+	return bWasRequested;
+}
+
+void FOmniSyncWatcher::OnDirectoryChanged( const TArray< FFileChangeData >& FileChanges )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FString > ChangedFiles;
+	for( const FFileChangeData& Change: FileChanges )
+	{
+		if( Change.Action == FFileChangeData::FCA_RescanRequired )
+		{
+			bRescanRequested = true;
+			continue;
+		}
+
+		// Stores announce every write through their generations file, whatever the storage mode keeps the contents in
+		if( !Change.Filename.EndsWith( TEXT( ".ini" ) ) && FPaths::GetCleanFilename( Change.Filename ) != FOmniSyncGenerations::FileName )
+			continue;
+
+		FString Filename = FPaths::ConvertRelativePathToFull( Change.Filename );
+		FPaths::NormalizeFilename( Filename );
+		ChangedFiles.AddUnique( Filename );
+	}
+
+	if( !ChangedFiles.IsEmpty() )
+		OnFilesChanged.ExecuteIfBound( ChangedFiles );
+}
\ No newline at end of file
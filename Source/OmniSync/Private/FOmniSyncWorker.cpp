@@ -0,0 +1,127 @@
+#include "FOmniSyncWorker.h"
+
+#include "Async/Async.h"
+#include "FOmniSyncStats.h"
+#include "HAL/RunnableThread.h"
+#include "Macros.h"
+
+FOmniSyncWorker::FOmniSyncWorker()
+{
+	TRACE_CPU_SCOPE;
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool( false );
+	Thread    = FRunnableThread::Create( this, TEXT( "OmniSyncWorker" ), 0, TPri_BelowNormal );
+}
+
+FOmniSyncWorker::~FOmniSyncWorker()
+{
+	TRACE_CPU_SCOPE;
+
+	CancelAll();
+
+	if( Thread )
+	{
+		Thread->Kill( true );
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool( WakeEvent );
+	WakeEvent = nullptr;
+}
+
+uint32 FOmniSyncWorker::Enqueue( FJob&& Work, const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+
+	FQueuedJob Job;
+	Job.Id          = NextJobId++;
+	Job.Work        = MoveTemp( Work );
+	Job.OnCompleted = OnCompleted;
+	Job.EnqueueTime = FPlatformTime::Seconds();
+
+	const uint32 JobId = Job.Id;
+
+	++PendingJobs;
+	FOmniSyncStats::AddPendingJobs( 1 );
+	Queue.Enqueue( MoveTemp( Job ) );
+	WakeEvent->Trigger();
+
+	return JobId;
+}
+
+void FOmniSyncWorker::Cancel( const uint32 JobId )
+{
+	TRACE_CPU_SCOPE;
+
+	FScopeLock Lock( &CancelLock );
+	if( JobId == CurrentJobId )
+		bCancelled = true;
+	else
+		CancelledJobs.Add( JobId );
+}
+
+void FOmniSyncWorker::CancelAll()
+{
+	TRACE_CPU_SCOPE;
+
+	FScopeLock Lock( &CancelLock );
+	CancelBeforeId = NextJobId.load();
+	bCancelled     = CurrentJobId != 0;
+}
+
+void FOmniSyncWorker::WaitUntilIdle() const
+{
+	TRACE_CPU_SCOPE;
+
+	while( !IsIdle() )
+		FPlatformProcess::Sleep( 0.001f );
+}
+
+uint32 FOmniSyncWorker::Run()
+{
+	while( !bStopping )
+	{
+		FQueuedJob Job;
+		if( !Queue.Dequeue( Job ) )
+		{
+			WakeEvent->Wait();
+			continue;
+		}
+
+		{
+			FScopeLock Lock( &CancelLock );
+			CurrentJobId = Job.Id;
+			bCancelled   = Job.Id < CancelBeforeId || CancelledJobs.Remove( Job.Id ) > 0;
+		}
+
+		bool bSucceeded = false;
+		if( !bCancelled )
+		{
+			TRACE_CPU_SCOPE_STR( "Job" );
+			bSucceeded = Job.Work( bCancelled ) && !bCancelled;
+		}
+
+		{
+			FScopeLock Lock( &CancelLock );
+			CurrentJobId = 0;
+			bCancelled   = false;
+		}
+
+		if( Job.OnCompleted.IsBound() )
+			AsyncTask( ENamedThreads::GameThread, [OnCompleted = MoveTemp( Job.OnCompleted ), bSucceeded] { OnCompleted.ExecuteIfBound( bSucceeded ); } );
+
+		// Job latency covers the time spent queued behind other jobs as well
+		FOmniSyncStats::RecordLatency( EOmniSyncOperation::Job, FPlatformTime::Seconds() - Job.EnqueueTime );
+		FOmniSyncStats::AddPendingJobs( -1 );
+		--PendingJobs;
+	}
+
+	return 0;
+}
+
+void FOmniSyncWorker::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
\ No newline at end of file
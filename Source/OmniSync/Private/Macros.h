@@ -1,4 +1,5 @@
 ﻿#pragma once
 
 #define TRACE_CPU_SCOPE_STR( String )	TRACE_CPUPROFILER_EVENT_SCOPE_STR( TEXT( __FUNCTION__ "::" PREPROCESSOR_TO_STRING( __LINE__ ) "::"  String ) )
-#define TRACE_CPU_SCOPE					TRACE_CPUPROFILER_EVENT_SCOPE_STR( TEXT( __FUNCTION__ "::" PREPROCESSOR_TO_STRING( __LINE__ ) ) )
\ No newline at end of file
+#define TRACE_CPU_SCOPE					TRACE_CPUPROFILER_EVENT_SCOPE_STR( TEXT( __FUNCTION__ "::" PREPROCESSOR_TO_STRING( __LINE__ ) ) )
+#define TRACE_SYNC_SCOPE( Name )		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL( Name, OmniSyncChannel )
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include "UOmniSyncCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "FOmniSync.h"
+#include "FOmniSyncHistory.h"
+#include "FOmniSyncReport.h"
+#include "Macros.h"
+#include "Serialization/JsonSerializer.h"
+#include "UOmniSyncSettings.h"
+
+namespace
+{
+	constexpr int32 ExitSuccess   = 0;
+	constexpr int32 ExitUsage     = 1;
+	constexpr int32 ExitOutOfSync = 2;
+	constexpr int32 ExitFailed    = 3;
+
+	const TCHAR* UsageText = TEXT( "Usage: -run=OmniSync <discover|push|pull|verify|diff|history <File>|restore <File> <Version>> [-Sequential] [-Json=<File>]" );
+
+	FString GetScopeName( const EOmniSyncScope Scope )
+	{
+		return StaticEnum< EOmniSyncScope >()->GetNameStringByValue( static_cast< int64 >( Scope ) );
+	}
+
+	TSharedRef< FJsonObject > MakeFileObject( const FString& RelativePath, const FString& State )
+	{
+		const TSharedRef< FJsonObject > FileObject = MakeShared< FJsonObject >();
+		FileObject->SetStringField( TEXT( "Path" ), RelativePath );
+		FileObject->SetStringField( TEXT( "State" ), State );
+		return FileObject;
+	}
+}
+
+UOmniSyncCommandlet::UOmniSyncCommandlet()
+{
+	IsClient     = false;
+	IsServer     = false;
+	IsEditor     = true;
+	LogToConsole = true;
+}
+
+int32 UOmniSyncCommandlet::Main( const FString& Params )
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FString >        Tokens;
+	TArray< FString >        Switches;
+	TMap< FString, FString > ParamValues;
+	ParseCommandLine( *Params, Tokens, Switches, ParamValues );
+
+	// The project file may come through as a token too, the first known operation wins
+	static const TArray< FString > Commands = { TEXT( "discover" ), TEXT( "push" ), TEXT( "pull" ), TEXT( "verify" ), TEXT( "diff" ), TEXT( "history" ), TEXT( "restore" ) };
+
+	const int32 CommandIndex = Tokens.IndexOfByPredicate( []( const FString& Token ) { return Commands.Contains( Token.ToLower() ); } );
+	if( CommandIndex == INDEX_NONE )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "%s" ), UsageText );
+		return ExitUsage;
+	}
+
+	const FString           Operation = Tokens[ CommandIndex ].ToLower();
+	const TArray< FString > Arguments( Tokens.GetData() + CommandIndex + 1, Tokens.Num() - CommandIndex - 1 );
+
+	if( ( Operation == TEXT( "history" ) && Arguments.Num() < 1 ) || ( Operation == TEXT( "restore" ) && ( Arguments.Num() < 2 || !Arguments[ 1 ].IsNumeric() ) ) )
+	{
+		UE_LOG( OmniSync, Error, TEXT( "%s" ), UsageText );
+		return ExitUsage;
+	}
+
+	const double  StartTime = FPlatformTime::Seconds();
+
+	if( Switches.Contains( TEXT( "Sequential" ) ) )
+	{
+		if( IConsoleVariable* ParallelSync = IConsoleManager::Get().FindConsoleVariable( TEXT( "OmniSync.ParallelSync" ) ) )
+			ParallelSync->Set( false, ECVF_SetByCommandline );
+	}
+
+	UOmniSyncSettings& Settings = *UOmniSyncSettings::Get();
+
+	int32                              ExitCode = ExitSuccess;
+	TArray< TSharedPtr< FJsonValue > > FileValues;
+
+	if( Operation == TEXT( "discover" ) )
+	{
+		// UOmniSyncSettings::Get() already scanned on startup, the index makes this second pass cheap and picks up anything added since
+		Settings.DiscoverAndAddConfigFiles();
+
+		for( const FConfigFileSettings& Setting: Settings.ConfigFileSettingsStruct.Settings )
+		{
+			const TSharedRef< FJsonObject > FileObject = MakeFileObject( Setting.RelativePath, Setting.bEnabled ? TEXT( "Enabled" ) : TEXT( "Disabled" ) );
+			FileObject->SetStringField( TEXT( "Scope" ), GetScopeName( Setting.SettingsScope ) );
+			FileValues.Add( MakeShared< FJsonValueObject >( FileObject ) );
+		}
+
+		UE_LOG( OmniSync, Display, TEXT( "Discovered %d config files" ), Settings.ConfigFileSettingsStruct.Settings.Num() );
+	}
+	else if( Operation == TEXT( "push" ) || Operation == TEXT( "pull" ) )
+	{
+		TArray< FString > SyncedFiles;
+		TArray< FString > FailedFiles;
+
+		const FDelegateHandle FilesSyncedHandle = Settings.OnFilesSynced().AddLambda( [&]( const TArray< FString >& InSyncedFiles, const TArray< FString >& InFailedFiles )
+		{
+			SyncedFiles.Append( InSyncedFiles );
+			FailedFiles.Append( InFailedFiles );
+		} );
+
+		if( Operation == TEXT( "push" ) )
+			Settings.SaveSettingsToGlobal();
+		else
+			Settings.LoadSettingsFromGlobal();
+
+		WaitForJobs( Settings );
+		Settings.OnFilesSynced().Remove( FilesSyncedHandle );
+
+		for( const FString& SyncedFile: SyncedFiles )
+			FileValues.Add( MakeShared< FJsonValueObject >( MakeFileObject( SyncedFile, TEXT( "Synced" ) ) ) );
+
+		for( const FString& FailedFile: FailedFiles )
+		{
+			FileValues.Add( MakeShared< FJsonValueObject >( MakeFileObject( FailedFile, TEXT( "Failed" ) ) ) );
+			UE_LOG( OmniSync, Error, TEXT( "Failed to %s %s" ), *Operation, *FailedFile );
+		}
+
+		UE_LOG( OmniSync, Display, TEXT( "%s: %d files synced, %d failed" ), *Operation, SyncedFiles.Num(), FailedFiles.Num() );
+
+		if( !FailedFiles.IsEmpty() )
+			ExitCode = ExitFailed;
+	}
+	else if( Operation == TEXT( "history" ) )
+	{
+		const FString& RelativePath = Arguments[ 0 ];
+
+		TArray< FOmniSyncHistoryVersion > Versions;
+		Settings.LoadHistory( RelativePath, FOnHistoryLoaded::CreateLambda( [&Versions]( const TArray< FOmniSyncHistoryVersion >& InVersions ) { Versions = InVersions; } ) );
+		WaitForJobs( Settings );
+
+		for( const FOmniSyncHistoryVersion& Version: Versions )
+		{
+			const TSharedRef< FJsonObject > VersionObject = MakeShared< FJsonObject >();
+			VersionObject->SetStringField( TEXT( "Path" ), RelativePath );
+			VersionObject->SetNumberField( TEXT( "Version" ), Version.Version );
+			VersionObject->SetStringField( TEXT( "Time" ), Version.Time.ToIso8601() );
+			VersionObject->SetNumberField( TEXT( "Size" ), Version.Size );
+			FileValues.Add( MakeShared< FJsonValueObject >( VersionObject ) );
+
+			UE_LOG( OmniSync, Display, TEXT( "%8lld  %s  %d bytes" ), Version.Version, *Version.Time.ToIso8601(), Version.Size );
+		}
+
+		UE_LOG( OmniSync, Display, TEXT( "history: %d versions of %s" ), FileValues.Num(), *RelativePath );
+	}
+	else if( Operation == TEXT( "restore" ) )
+	{
+		const FString& RelativePath = Arguments[ 0 ];
+		const int64    Version      = FCString::Atoi64( *Arguments[ 1 ] );
+
+		bool bRestored = false;
+		Settings.RestoreVersion( RelativePath, Version, FOnSyncJobCompleted::CreateLambda( [&bRestored]( const bool bSucceeded ) { bRestored = bSucceeded; } ) );
+		WaitForJobs( Settings );
+
+		FileValues.Add( MakeShared< FJsonValueObject >( MakeFileObject( RelativePath, bRestored ? TEXT( "Restored" ) : TEXT( "Failed" ) ) ) );
+		UE_LOG( OmniSync, Display, TEXT( "restore: version %lld of %s %s" ), Version, *RelativePath, bRestored ? TEXT( "restored" ) : TEXT( "failed" ) );
+
+		if( !bRestored )
+			ExitCode = ExitFailed;
+	}
+	else
+	{
+		const bool                    bWithChanges = Operation == TEXT( "diff" );
+		TArray< FOmniSyncFileReport > Reports;
+
+		Settings.VerifyWithGlobal( bWithChanges, FOnVerifyCompleted::CreateLambda( [&Reports]( const TArray< FOmniSyncFileReport >& InReports ) { Reports = InReports; } ) );
+		WaitForJobs( Settings );
+
+		int32 OutOfSyncFiles = 0;
+		for( const FOmniSyncFileReport& Report: Reports )
+		{
+			const TSharedRef< FJsonObject > FileObject = MakeFileObject( Report.RelativePath, LexToString( Report.State ) );
+			FileObject->SetStringField( TEXT( "Scope" ), GetScopeName( Report.Scope ) );
+
+			if( bWithChanges )
+			{
+				TArray< TSharedPtr< FJsonValue > > ChangeValues;
+				for( const FOmniSyncIniChange& Change: Report.Changes )
+				{
+					ChangeValues.Add( MakeShared< FJsonValueString >( FString::Printf( TEXT( "[%s] %s" ), *Change.Section, *Change.Key ) ) );
+					UE_LOG( OmniSync, Display, TEXT( "  %s [%s] %s" ), *Report.RelativePath, *Change.Section, *Change.Key );
+				}
+
+				FileObject->SetArrayField( TEXT( "Changes" ), ChangeValues );
+			}
+
+			FileValues.Add( MakeShared< FJsonValueObject >( FileObject ) );
+
+			if( Report.State != EOmniSyncFileState::InSync )
+			{
+				UE_LOG( OmniSync, Display, TEXT( "%-10s %s" ), LexToString( Report.State ), *Report.RelativePath );
+				OutOfSyncFiles++;
+			}
+		}
+
+		UE_LOG( OmniSync, Display, TEXT( "%s: %d of %d files out of sync" ), *Operation, OutOfSyncFiles, Reports.Num() );
+
+		if( OutOfSyncFiles > 0 )
+			ExitCode = ExitOutOfSync;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	UE_LOG( OmniSync, Display, TEXT( "OmniSync %s finished in %.2f s with exit code %d" ), *Operation, Seconds, ExitCode );
+
+	if( const FString* JsonFile = ParamValues.Find( TEXT( "Json" ) ) )
+	{
+		const TSharedRef< FJsonObject > RootObject = MakeShared< FJsonObject >();
+		RootObject->SetStringField( TEXT( "Command" ), Operation );
+		RootObject->SetStringField( TEXT( "Project" ), FApp::GetProjectName() );
+		RootObject->SetNumberField( TEXT( "Seconds" ), Seconds );
+		RootObject->SetNumberField( TEXT( "ExitCode" ), ExitCode );
+		RootObject->SetArrayField( TEXT( "Files" ), FileValues );
+
+		FString                           OutputString;
+		const TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create( &OutputString );
+		if( !FJsonSerializer::Serialize( RootObject, Writer ) || !FFileHelper::SaveStringToFile( OutputString, **JsonFile ) )
+			UE_LOG( OmniSync, Error, TEXT( "Failed to write the summary to %s" ), **JsonFile );
+	}
+
+	Settings.Shutdown();
+	return ExitCode;
+}
+
+void UOmniSyncCommandlet::WaitForJobs( UOmniSyncSettings& Settings )
+{
+	TRACE_CPU_SCOPE;
+
+	// Jobs hand their results to the game thread, which has no engine loop pumping it while a commandlet runs
+	Settings.WaitUntilIdle();
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle( ENamedThreads::GameThread );
+}
\ No newline at end of file
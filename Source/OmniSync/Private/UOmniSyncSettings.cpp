@@ -1,9 +1,102 @@
 #include "UOmniSyncSettings.h"
 
+#include "Algo/IndexOf.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "FOmniSync.h"
-#include "JsonObjectConverter.h"
+#include "FOmniSyncBlobStorage.h"
+#include "FOmniSyncBundle.h"
+#include "FOmniSyncConfigApplier.h"
+#include "FOmniSyncDiscovery.h"
+#include "FOmniSyncFileCopy.h"
+#include "FOmniSyncFileStorage.h"
+#include "FOmniSyncGenerations.h"
+#include "FOmniSyncHistory.h"
+#include "FOmniSyncIni.h"
+#include "FOmniSyncLayeredStorage.h"
+#include "FOmniSyncManifest.h"
+#include "FOmniSyncPackStorage.h"
+#include "FOmniSyncPathRules.h"
+#include "FOmniSyncPlan.h"
+#include "FOmniSyncReport.h"
+#include "FOmniSyncScheduler.h"
+#include "FOmniSyncSettingsStore.h"
+#include "FOmniSyncStats.h"
+#include "FOmniSyncWatcher.h"
+#include "FOmniSyncWorker.h"
 #include "Macros.h"
 
+namespace
+{
+	TAutoConsoleVariable< bool > CVarParallelSync( TEXT( "OmniSync.ParallelSync" ),
+	                                               true,
+	                                               TEXT( "Sync the files of a job in parallel, only manifest and store access is serialized" ) );
+
+	// Another editor holds a scope's lock for one batch at most, waiting longer means it is stuck
+	constexpr double ScopeLockTimeoutSeconds = 5.0;
+
+	EParallelForFlags GetSyncParallelForFlags()
+	{
+		// File sizes and merge work vary a lot, so workers pick up files one by one instead of in fixed batches
+		return CVarParallelSync.GetValueOnAnyThread() ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread;
+	}
+
+	FString MakeScopeDirectory( const FString& StoreRoot, const EOmniSyncScope Scope )
+	{
+		switch( Scope )
+		{
+			case EOmniSyncScope::Global:
+				return FPaths::Combine( StoreRoot, "Global" );
+			case EOmniSyncScope::PerEngineVersion:
+				return FPaths::Combine( StoreRoot, "PerEngineVersion", FString::Printf( TEXT( "%d.%d" ), ENGINE_MAJOR_VERSION, ENGINE_MINOR_VERSION ) );
+			case EOmniSyncScope::PerProject:
+				return FPaths::Combine( StoreRoot, "PerProject", FApp::GetProjectName() );
+			default:
+				return StoreRoot;
+		}
+	}
+
+	struct FScopeRedirect
+	{
+		const FString*        Directory   = nullptr;
+		FOmniSyncGenerations* Generations = nullptr;
+	};
+
+	// Set on the worker while a bundle reads or writes the directory of another engine version or project, every store path and
+	// generation of that scope then resolves to it on this thread only
+	thread_local FScopeRedirect ScopeRedirects[ static_cast< uint8 >( EOmniSyncScope::PerProject ) + 1 ];
+
+	class FScopedScopeRedirect
+	{
+	public:
+		FScopedScopeRedirect( const EOmniSyncScope InScope, const FString& Directory, FOmniSyncGenerations* Generations )
+			: Scope( static_cast< uint8 >( InScope ) )
+			, Previous( ScopeRedirects[ Scope ] )
+		{
+			ScopeRedirects[ Scope ] = { &Directory, Generations };
+		}
+
+		~FScopedScopeRedirect() { ScopeRedirects[ Scope ] = Previous; }
+
+	private:
+		uint8          Scope;
+		FScopeRedirect Previous;
+	};
+
+	TSharedRef< IOmniSyncStorage > MakeStorage( const EOmniSyncStorageMode Mode, const bool bCompress )
+	{
+		switch( Mode )
+		{
+			case EOmniSyncStorageMode::ContentAddressed:
+				return MakeShared< FOmniSyncBlobStorage >( bCompress );
+			case EOmniSyncStorageMode::Packed:
+				return MakeShared< FOmniSyncPackStorage >();
+			default:
+				return MakeShared< FOmniSyncFileStorage >();
+		}
+	}
+}
+
 UOmniSyncSettings* UOmniSyncSettings::Get()
 {
 	TRACE_CPU_SCOPE;
@@ -13,6 +106,7 @@ UOmniSyncSettings* UOmniSyncSettings::Get()
 		Instance = GetMutableDefault< UOmniSyncSettings >();
 		Instance->AddToRoot();
 		Instance->LoadPluginSettings();
+		Instance->RebuildSettingsIndex();
 		Instance->DiscoverAndAddConfigFiles();
 	}
 
@@ -21,150 +115,474 @@ UOmniSyncSettings* UOmniSyncSettings::Get()
 
 void UOmniSyncSettings::DiscoverAndAddConfigFiles()
 {
-	TRACE_CPU_SCOPE;
-
-	IPlatformFile&    PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	TArray< FString > AllConfigPaths;
-
-	static const FString ProjectConfigDir = FPaths::ProjectConfigDir();
-	TArray< FString >    ConfigDirFiles;
-	PlatformFile.FindFiles( ConfigDirFiles, *ProjectConfigDir, TEXT( ".ini" ) );
-
-	for( const FString& FilePath: ConfigDirFiles )
-		AllConfigPaths.AddUnique( FilePath );
-
-	static const FString SavedConfigDir = FPaths::Combine( FPaths::ProjectSavedDir(), "Config" );
-	TArray< FString >    SavedConfigFiles;
-	PlatformFile.FindFilesRecursively( SavedConfigFiles, *SavedConfigDir, TEXT( ".ini" ) );
+	DiscoverAndAddConfigFiles( FOmniSyncDiscovery::GetProjectRoots() );
+}
 
-	for( const FString& FilePath: SavedConfigFiles )
-		AllConfigPaths.AddUnique( FilePath );
+void UOmniSyncSettings::DiscoverAndAddConfigFiles( const TArray< FOmniSyncDiscoveryRoot >& Roots )
+{
+	TRACE_CPU_SCOPE;
 
-	static const FString PluginsDir = FPaths::ProjectPluginsDir();
-	TArray< FString >    PluginConfigFiles;
-	PlatformFile.FindFilesRecursively( PluginConfigFiles, *PluginsDir, TEXT( ".ini" ) );
+	if( !DirectoryIndex.IsValid() )
+	{
+		DirectoryIndex = MakeShared< FOmniSyncDirectoryIndex >( GetDirectoryIndexFilePath() );
+		DirectoryIndex->Load();
+	}
 
-	for( const FString& FilePath: PluginConfigFiles )
-		AllConfigPaths.AddUnique( FilePath );
+	FOmniSyncDiscoveryStats DiscoveryStats;
+	TArray< FString >       AllConfigPaths = FOmniSyncDiscovery::FindConfigFiles( Roots, &DiscoveryStats, DirectoryIndex.Get(), &GetPathRules().Get() );
 
-	TSet< FString > ExistingFileNames;
-	for( const FConfigFileSettings& Filter: ConfigFileSettingsStruct.Settings )
-		ExistingFileNames.Add( Filter.FileName );
+	if( DiscoveryStats.DirectoriesCached != DiscoveryStats.DirectoriesVisited )
+		DirectoryIndex->Save();
 
+	// Keyed by the full relative path, plugins ship their own DefaultGame.ini and friends next to the project's
 	static const FString ProjectDir = FPaths::ProjectDir();
 	int32                FilesAdded = 0;
 	for( FString& ConfigPath: AllConfigPaths )
 	{
-		const FString Filename = FPaths::GetCleanFilename( ConfigPath );
-		if( ExistingFileNames.Contains( Filename ) )
+		FPaths::MakePathRelativeTo( ConfigPath, *ProjectDir );
+		if( FindSetting( ConfigPath ) )
 			continue;
 
-		FConfigFileSettings Setting{};
-		Setting.FileName = Filename;
+		AddSetting( ConfigPath );
+		FilesAdded++;
+	}
 
-		FPaths::MakePathRelativeTo( ConfigPath, *ProjectDir );
-		Setting.RelativePath = ConfigPath;
+	// Files found before a rule excluded them only drop out of the list while disabled, enabled ones keep their settings but are no longer synced
+	const TSharedRef< const FOmniSyncPathRules > Rules = GetPathRules();
 
-		FilesAdded++;
-		ConfigFileSettingsStruct.Settings.Add( Setting );
+	TArray< FString > ExcludedPaths;
+	for( const FConfigFileSettings& Setting: ConfigFileSettingsStruct.Settings )
+	{
+		if( !Setting.bEnabled && Rules->IsExcluded( Setting.RelativePath ) )
+			ExcludedPaths.Add( Setting.RelativePath );
 	}
 
-	if( FilesAdded > 0 )
+	for( const FString& ExcludedPath: ExcludedPaths )
+		RemoveSetting( ExcludedPath );
+
+	if( FilesAdded > 0 || !ExcludedPaths.IsEmpty() )
 		SavePluginSettings();
 }
 
-void UOmniSyncSettings::SaveSettingsToGlobal()
+FConfigFileSettings* UOmniSyncSettings::FindSetting( const FString& RelativePath )
+{
+	const int32* Index = SettingsIndex.Find( NormalizeRelativePath( RelativePath ) );
+	return Index ? &ConfigFileSettingsStruct.Settings[ *Index ] : nullptr;
+}
+
+FConfigFileSettings& UOmniSyncSettings::AddSetting( const FString& RelativePath )
 {
 	TRACE_CPU_SCOPE;
 
-	static const FString ProjectDir = FPaths::ProjectDir();
-	for( const FConfigFileSettings& Setting: ConfigFileSettingsStruct.Settings )
+	FString NormalizedPath = NormalizeRelativePath( RelativePath );
+	if( const int32* Index = SettingsIndex.Find( NormalizedPath ) )
+		return ConfigFileSettingsStruct.Settings[ *Index ];
+
+	FConfigFileSettings& Setting = ConfigFileSettingsStruct.Settings.AddDefaulted_GetRef();
+	Setting.FileName             = FPaths::GetCleanFilename( RelativePath );
+	Setting.RelativePath         = RelativePath;
+
+	DirtySettings.Add( NormalizedPath );
+	SettingsIndex.Add( MoveTemp( NormalizedPath ), ConfigFileSettingsStruct.Settings.Num() - 1 );
+	bSyncPlanDirty = true;
+	return Setting;
+}
+
+bool UOmniSyncSettings::RemoveSetting( const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	const FString NormalizedPath = NormalizeRelativePath( RelativePath );
+
+	int32 Index = INDEX_NONE;
+	if( !SettingsIndex.RemoveAndCopyValue( NormalizedPath, Index ) )
+		return false;
+
+	// Swapping keeps removal constant time, only the entry that moved into the hole needs its index fixed
+	TArray< FConfigFileSettings >& Settings = ConfigFileSettingsStruct.Settings;
+	Settings.RemoveAtSwap( Index );
+	if( Settings.IsValidIndex( Index ) )
+		SettingsIndex.Add( NormalizeRelativePath( Settings[ Index ].RelativePath ), Index );
+
+	DirtySettings.Add( NormalizedPath );
+	bSyncPlanDirty = true;
+	return true;
+}
+
+FString UOmniSyncSettings::NormalizeRelativePath( const FString& RelativePath )
+{
+	FString NormalizedPath = RelativePath;
+	FPaths::NormalizeFilename( NormalizedPath );
+	return NormalizedPath;
+}
+
+void UOmniSyncSettings::Shutdown()
+{
+	TRACE_CPU_SCOPE;
+
+	DisableAutoSync();
+
+	if( Scheduler.IsValid() )
+		Scheduler->Flush();
+	Scheduler.Reset();
+
+	// Let queued saves reach the disk before the editor goes away
+	if( Worker.IsValid() )
+		Worker->WaitUntilIdle();
+
+	Worker.Reset();
+}
+
+uint32 UOmniSyncSettings::SaveSettingsToGlobal( const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+	return EnqueueSync( {}, false, true, OnCompleted );
+}
+
+uint32 UOmniSyncSettings::LoadSettingsFromGlobal( const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+	return EnqueueSync( {}, false, false, OnCompleted );
+}
+
+void UOmniSyncSettings::CancelSync( const uint32 JobId )
+{
+	TRACE_CPU_SCOPE;
+
+	if( Worker.IsValid() )
+		Worker->Cancel( JobId );
+}
+
+uint32 UOmniSyncSettings::ExportBundle( const FString& File, const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+
+	const EOmniSyncStorageMode StorageMode = ConfigFileSettingsStruct.StorageMode;
+	const bool                 bCompress   = ConfigFileSettingsStruct.bCompressBlobs;
+
+	FOmniSyncWorker::FJob Job = [this, File, StorageMode, bCompress]( const FThreadSafeBool& )
+	{
+		return FOmniSyncBundle::Export( [this, StorageMode, bCompress]( const EOmniSyncScope Scope, const FString& Directory, const FOmniSyncBundle::FReadStorage Read )
+		{
+			if( FPaths::IsSamePath( Directory, GetScopedSettingsDirectory( Scope ) ) )
+			{
+				Read( GetStorage( StorageMode, bCompress ) );
+				return;
+			}
+
+			// Other engine versions and projects are read through a backend of their own, this editor's keeps its cached manifests
+			FScopedScopeRedirect                 Redirect( Scope, Directory, nullptr );
+			const TSharedRef< IOmniSyncStorage > Store = MakeStorage( StorageMode, bCompress );
+			Read( *Store );
+		}, File );
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ), OnCompleted );
+}
+
+uint32 UOmniSyncSettings::ImportBundle( const FString& File, const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+
+	const EOmniSyncStorageMode StorageMode = ConfigFileSettingsStruct.StorageMode;
+	const bool                 bCompress   = ConfigFileSettingsStruct.bCompressBlobs;
+
+	FOmniSyncWorker::FJob Job = [this, File, StorageMode, bCompress]( const FThreadSafeBool& )
+	{
+		IOmniSyncStorage& Store = GetStorage( StorageMode, bCompress );
+
+		// Imported files are written like any push, so they bump their generation and enter the history while the scope is locked
+		const EOmniSyncScope Scopes[] = { EOmniSyncScope::Global, EOmniSyncScope::PerEngineVersion, EOmniSyncScope::PerProject };
+		for( const EOmniSyncScope Scope: Scopes )
+		{
+			if( !GetGenerations( Scope ).TryLock( ScopeLockTimeoutSeconds ) )
+				UE_LOG( OmniSync, Warning, TEXT( "Importing into %s without its lock, another editor is holding it" ), *UEnum::GetValueAsString( Scope ) );
+		}
+
+		// Directories of other engine versions and projects get a backend and generations of their own, locked on first use
+		struct FOtherDirectory
+		{
+			EOmniSyncScope                     Scope = EOmniSyncScope::Global;
+			TSharedPtr< IOmniSyncStorage >     Store;
+			TUniquePtr< FOmniSyncGenerations > Generations;
+		};
+
+		TMap< FString, FOtherDirectory > OtherDirectories;
+
+		auto WriteFile = [&]( const EOmniSyncScope Scope, const FString& Directory, const FString& RelativePath, const TArray< uint8 >& Bytes, const uint64 Hash )
+		{
+			if( FPaths::IsSamePath( Directory, GetScopedSettingsDirectory( Scope ) ) )
+				return WriteToStore( Store, Scope, RelativePath, Bytes, Hash );
+
+			FOtherDirectory* Other = OtherDirectories.Find( Directory );
+			if( !Other )
+			{
+				Other              = &OtherDirectories.Add( Directory );
+				Other->Scope       = Scope;
+				Other->Store       = MakeStorage( StorageMode, bCompress );
+				Other->Generations = MakeUnique< FOmniSyncGenerations >( Directory );
+				if( !Other->Generations->TryLock( ScopeLockTimeoutSeconds ) )
+					UE_LOG( OmniSync, Warning, TEXT( "Importing into %s without its lock, another editor is holding it" ), *Directory );
+			}
+
+			FScopedScopeRedirect Redirect( Scope, Directory, Other->Generations.Get() );
+			return WriteToStore( *Other->Store, Scope, RelativePath, Bytes, Hash );
+		};
+
+		const bool bImported = FOmniSyncBundle::Import( File, WriteFile );
+
+		bool bFlushed = FlushStorage( Scopes );
+		SaveManifests();
+
+		for( const EOmniSyncScope Scope: Scopes )
+			GetGenerations( Scope ).Release();
+
+		for( TPair< FString, FOtherDirectory >& Pair: OtherDirectories )
+		{
+			FScopedScopeRedirect Redirect( Pair.Value.Scope, Pair.Key, Pair.Value.Generations.Get() );
+			if( !Pair.Value.Store->Flush() )
+			{
+				Pair.Value.Generations->DiscardBumps();
+				bFlushed = false;
+			}
+
+			Pair.Value.Generations->Release();
+		}
+
+		return bImported && bFlushed;
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ), OnCompleted );
+}
+
+uint32 UOmniSyncSettings::CollectBlobs( const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncWorker::FJob Job = [this]( const FThreadSafeBool& )
+	{
+		// Manifests this editor still holds in memory are saved first, their blobs would otherwise look unreferenced
+		SaveManifests();
+		return FOmniSyncBlobStorage::CollectGarbage() != INDEX_NONE;
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ), OnCompleted );
+}
+
+void UOmniSyncSettings::OnSettingsChanged( const FString& RelativePath )
+{
+	OnSettingsChanged( MakeArrayView( &RelativePath, 1 ) );
+}
+
+void UOmniSyncSettings::OnSettingsChanged( const TConstArrayView< FString > RelativePaths )
+{
+	TRACE_CPU_SCOPE;
+
+	// The plan still holds the state of the previous change, only enabling a file, moving it to another scope or (un)layering it needs a copy
+	TArray< FString > CopyPaths;
+	for( const FString& RelativePath: RelativePaths )
 	{
-		if( !Setting.bEnabled )
+		const FConfigFileSettings* Setting = FindSetting( RelativePath );
+		if( !Setting )
 			continue;
 
-		const FString Source      = FPaths::Combine( ProjectDir, Setting.RelativePath );
-		const FString Destination = FPaths::Combine( GetScopedSettingsDirectory( Setting.SettingsScope ), Setting.RelativePath );
-		CopyIniFile( Source, Destination );
+		FString     NormalizedPath = NormalizeRelativePath( RelativePath );
+		const int32 PreviousIndex  = SyncPlan.IsValid() ? SyncPlan->Find( NormalizedPath ) : INDEX_NONE;
+		const bool  bScopeChanged  = PreviousIndex == INDEX_NONE
+		                          || SyncPlan->GetEntries()[ PreviousIndex ].Scope != Setting->SettingsScope
+		                          || EnumHasAnyFlags( SyncPlan->GetEntries()[ PreviousIndex ].Flags, EOmniSyncPlanFlags::Layered ) != Setting->bLayered;
+
+		DirtySettings.Add( NormalizedPath );
+		if( Setting->bEnabled && bScopeChanged )
+			CopyPaths.Add( MoveTemp( NormalizedPath ) );
+	}
+
+	bSyncPlanDirty = true;
+	const TSharedRef< const FOmniSyncPlan > Plan = GetSyncPlan();
+
+	// Toggles come in bursts, the scheduler folds them into one settings write
+	GetScheduler().ScheduleSettingsSave();
+
+	if( CopyPaths.IsEmpty() )
+		return;
+
+	// Files excluded by the path rules are not in the plan and are skipped
+	TArray< int32 > EntryIndices;
+	EntryIndices.Reserve( CopyPaths.Num() );
+	for( const FString& NormalizedPath: CopyPaths )
+	{
+		const int32 EntryIndex = Plan->Find( NormalizedPath );
+		if( EntryIndex != INDEX_NONE )
+			EntryIndices.Add( EntryIndex );
 	}
+
+	if( EntryIndices.IsEmpty() )
+		return;
+
+	EnqueueSync( MoveTemp( EntryIndices ), false, true );
 }
 
-void UOmniSyncSettings::LoadSettingsFromGlobal()
+void UOmniSyncSettings::SetSettingsEnabled( const TConstArrayView< FString > RelativePaths, const bool bEnabled )
 {
 	TRACE_CPU_SCOPE;
 
-	static const FString ProjectDir = FPaths::ProjectDir();
-	for( const FConfigFileSettings& Setting: ConfigFileSettingsStruct.Settings )
+	TArray< FString > ChangedPaths;
+	for( const FString& RelativePath: RelativePaths )
 	{
-		if( !Setting.bEnabled )
+		FConfigFileSettings* Setting = FindSetting( RelativePath );
+		if( !Setting || Setting->bEnabled == bEnabled )
 			continue;
 
-		const FString Source      = FPaths::Combine( GetScopedSettingsDirectory( Setting.SettingsScope ), Setting.RelativePath );
-		const FString Destination = FPaths::Combine( ProjectDir, Setting.RelativePath );
-		CopyIniFile( Source, Destination );
+		Setting->bEnabled = bEnabled;
+		ChangedPaths.Add( RelativePath );
 	}
+
+	if( !ChangedPaths.IsEmpty() )
+		OnSettingsChanged( ChangedPaths );
 }
 
-void UOmniSyncSettings::OnSettingsChanged()
+void UOmniSyncSettings::OnOptionsChanged()
 {
 	TRACE_CPU_SCOPE;
 
-	SavePluginSettings();
-	SaveSettingsToGlobal();
+	GetScheduler().SetQuietWindow( ConfigFileSettingsStruct.SyncQuietWindowSeconds );
+	GetScheduler().SetMaxDelay( ConfigFileSettingsStruct.SyncMaxDelaySeconds );
+
+	PathRules.Reset();
+	bSyncPlanDirty = true;
+	UpdateHistoryLimits();
+
+	bOptionsDirty = true;
+	GetScheduler().ScheduleSettingsSave();
 }
 
-void UOmniSyncSettings::SavePluginSettings() const
+void UOmniSyncSettings::SavePluginSettings()
 {
 	TRACE_CPU_SCOPE;
 
-	const FString SettingsFilePath = GetPluginSettingsFilePath();
-	const FString SettingsDir      = FPaths::GetPath( SettingsFilePath );
-	if( !EnsureDirectoryExists( SettingsDir ) )
-	{
-		UE_LOG( OmniSync, Error, TEXT( "Failed to create settings directory: %s" ), *SettingsDir );
+	if( !SettingsStore.IsValid() || ( !bSnapshotDirty && !bOptionsDirty && DirtySettings.IsEmpty() ) )
 		return;
-	}
 
-	FString OutputString;
-	if( !FJsonObjectConverter::UStructToJsonObjectString( ConfigFileSettingsStruct, OutputString, 0, 0, 0, nullptr, true ) )
+	const int32 NewRecords = DirtySettings.Num() + ( bOptionsDirty ? 1 : 0 );
+
+	// The journal is folded into a fresh snapshot once replaying it would cost more than reading every entry again
+	const bool      bCompact = bSnapshotDirty || JournalRecords + NewRecords > FMath::Max( 256, ConfigFileSettingsStruct.Settings.Num() );
+	TArray< uint8 > Bytes;
+	if( bCompact )
 	{
-		UE_LOG( OmniSync, Error, TEXT( "Failed to convert settings JSON: %s" ), *SettingsFilePath );
-		return;
+		Bytes          = FOmniSyncSettingsStore::MakeSnapshot( ConfigFileSettingsStruct );
+		JournalRecords = 0;
 	}
-
-	if( !FFileHelper::SaveStringToFile( OutputString, *SettingsFilePath ) )
+	else
 	{
-		UE_LOG( OmniSync, Error, TEXT( "Failed to write settings file: %s" ), *SettingsFilePath );
-		return;
+		for( const FString& RelativePath: DirtySettings )
+		{
+			if( const FConfigFileSettings* Setting = FindSetting( RelativePath ) )
+				FOmniSyncSettingsStore::AddEntryRecord( Bytes, *Setting );
+			else
+				FOmniSyncSettingsStore::AddRemoveRecord( Bytes, RelativePath );
+		}
+
+		if( bOptionsDirty )
+			FOmniSyncSettingsStore::AddOptionsRecord( Bytes, ConfigFileSettingsStruct );
+
+		JournalRecords += NewRecords;
 	}
 
-	UE_LOG( OmniSync, Log, TEXT( "Plugin settings saved to: %s" ), *SettingsFilePath );
+	DirtySettings.Empty();
+	bOptionsDirty  = false;
+	bSnapshotDirty = false;
+
+	FOmniSyncWorker::FJob Job = [Store = SettingsStore, Bytes = MoveTemp( Bytes ), bCompact]( const FThreadSafeBool& )
+	{
+		return bCompact ? Store->WriteSnapshot( Bytes ) : Store->AppendJournal( Bytes );
+	};
+
+	// A lost write leaves the files behind the settings in memory, the next save then starts from a full snapshot
+	GetWorker().Enqueue( MoveTemp( Job ), FOnSyncJobCompleted::CreateWeakLambda( this, [this]( const bool bSucceeded )
+	{
+		if( !bSucceeded )
+			bSnapshotDirty = true;
+	} ) );
 }
 
 void UOmniSyncSettings::LoadPluginSettings()
 {
 	TRACE_CPU_SCOPE;
 
-	const FString SettingsFilePath = GetPluginSettingsFilePath();
-
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	if( !PlatformFile.FileExists( *SettingsFilePath ) )
-		return;
+	if( !SettingsStore.IsValid() )
+		SettingsStore = MakeShared< FOmniSyncSettingsStore >( GetScopedSettingsDirectory( EOmniSyncScope::PerProject ) );
 
-	FString JsonString;
-	if( !FFileHelper::LoadFileToString( JsonString, *SettingsFilePath ) )
+	if( SettingsStore->Load( ConfigFileSettingsStruct, JournalRecords ) )
 	{
-		UE_LOG( OmniSync, Error, TEXT( "Failed to read settings file: %s" ), *SettingsFilePath );
+		UE_LOG( OmniSync, Log, TEXT( "Plugin settings loaded, %d entries and %d journal records" ), ConfigFileSettingsStruct.Settings.Num(), JournalRecords );
+		bSnapshotDirty = SettingsStore->NeedsCompaction();
 		return;
 	}
 
-	if( !FJsonObjectConverter::JsonObjectStringToUStruct( JsonString, &ConfigFileSettingsStruct ) )
+	// Settings written before the binary store are picked up from the JSON file once, the next save turns them into a snapshot
+	const FString SettingsFilePath = GetPluginSettingsFilePath();
+	if( FPlatformFileManager::Get().GetPlatformFile().FileExists( *SettingsFilePath ) && FOmniSyncSettingsStore::ImportJson( SettingsFilePath, ConfigFileSettingsStruct ) )
+		bSnapshotDirty = true;
+}
+
+void UOmniSyncSettings::ExportSettingsJson( const FString& File )
+{
+	TRACE_CPU_SCOPE;
+
+	FOmniSyncWorker::FJob Job = [File = File.IsEmpty() ? GetPluginSettingsFilePath() : File, Settings = ConfigFileSettingsStruct]( const FThreadSafeBool& )
 	{
-		UE_LOG( OmniSync, Error, TEXT( "Failed to convert settings JSON: %s" ), *SettingsFilePath );
+		return FOmniSyncSettingsStore::ExportJson( Settings, File );
+	};
+
+	GetWorker().Enqueue( MoveTemp( Job ) );
+}
+
+void UOmniSyncSettings::ImportSettingsJson( const FString& File )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !FOmniSyncSettingsStore::ImportJson( File.IsEmpty() ? GetPluginSettingsFilePath() : File, ConfigFileSettingsStruct ) )
 		return;
+
+	RebuildSettingsIndex();
+	OnOptionsChanged();
+
+	bSnapshotDirty = true;
+	SavePluginSettings();
+}
+
+void UOmniSyncSettings::RebuildSettingsIndex()
+{
+	TRACE_CPU_SCOPE;
+
+	TArray< FConfigFileSettings >& Settings = ConfigFileSettingsStruct.Settings;
+
+	SettingsIndex.Empty( Settings.Num() );
+	for( int32 Index = 0; Index < Settings.Num(); )
+	{
+		FString NormalizedPath = NormalizeRelativePath( Settings[ Index ].RelativePath );
+		if( SettingsIndex.Contains( NormalizedPath ) )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Dropping duplicate settings entry for %s" ), *Settings[ Index ].RelativePath );
+			Settings.RemoveAt( Index );
+			bSnapshotDirty = true;
+			continue;
+		}
+
+		SettingsIndex.Add( MoveTemp( NormalizedPath ), Index++ );
 	}
 
-	UE_LOG( OmniSync, Log, TEXT( "Plugin settings loaded from: %s" ), *SettingsFilePath );
+	PathRules.Reset();
+	bSyncPlanDirty = true;
+	UpdateHistoryLimits();
+}
+
+void UOmniSyncSettings::UpdateHistoryLimits()
+{
+	FScopeLock Lock( &SyncLock );
+	HistoryMaxVersions = ConfigFileSettingsStruct.HistoryMaxVersions;
+	HistoryMaxBytes    = static_cast< int64 >( ConfigFileSettingsStruct.HistoryMaxKilobytes ) * 1024;
 }
 
 void UOmniSyncSettings::EnableAutoSync()
@@ -174,93 +592,1179 @@ void UOmniSyncSettings::EnableAutoSync()
 	if( AutoSyncHandle.IsValid() )
 		return;
 
+	StartWatching();
+
 	AutoSyncHandle = FTSTicker::GetCoreTicker().AddTicker( FTickerDelegate::CreateUObject( this, &UOmniSyncSettings::AutoSyncTick ), 10 );
 }
 
-void UOmniSyncSettings::DisableAutoSync() const
+void UOmniSyncSettings::DisableAutoSync()
 {
 	TRACE_CPU_SCOPE;
 
 	FTSTicker::GetCoreTicker().RemoveTicker( AutoSyncHandle );
+	AutoSyncHandle.Reset();
+
+	Watcher.Reset();
+	PendingUpstreamScopes = 0;
+
+	if( Worker.IsValid() && AutoSyncJobId != 0 )
+		Worker->Cancel( AutoSyncJobId );
 }
 
 bool UOmniSyncSettings::AutoSyncTick( const float DeltaTime )
 {
 	TRACE_CPU_SCOPE;
 
-	IFileManager& FileManager = IFileManager::Get();
-
-	static const FString ProjectDir = FPaths::ProjectDir();
-	for( const FConfigFileSettings& Setting: ConfigFileSettingsStruct.Settings )
-	{
-		if( !Setting.bEnabled || !Setting.bAutoSyncEnabled )
-			continue;
-
-		const FString Source      = FPaths::Combine( ProjectDir, Setting.RelativePath );
-		const FString Destination = FPaths::Combine( GetScopedSettingsDirectory( Setting.SettingsScope ), Setting.RelativePath );
+	// The watcher covers every tracked file, so the poller only sweeps when it is unavailable or lost events
+	if( Watcher.IsValid() && Watcher->IsWatching() && !Watcher->ConsumeRescanRequest() )
+		return true;
 
-		if( FileManager.FileSize( *Source ) == FileManager.FileSize( *Destination ) )
-			continue;
+	// A slow store must not pile up sweeps, the queued one already covers every file
+	if( AutoSyncJobId != 0 )
+		return true;
 
-		CopyIniFile( Source, Destination );
-	}
+	if( GetSyncPlan()->Num( EOmniSyncPlanFlags::AutoSync ) > 0 )
+		AutoSyncJobId = EnqueueSync( {}, true, true, FOnSyncJobCompleted::CreateWeakLambda( this, [this]( bool ) { AutoSyncJobId = 0; } ) );
 
 	return true;
 }
 
-bool UOmniSyncSettings::CopyIniFile( const FString& Source, const FString& Destination )
+void UOmniSyncSettings::StartWatching()
 {
 	TRACE_CPU_SCOPE;
 
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	Watcher = MakeShared< FOmniSyncWatcher >( FOnWatchedFilesChanged::CreateUObject( this, &UOmniSyncSettings::OnWatchedFilesChanged ) );
 
-	if( !PlatformFile.FileExists( *Source ) )
-		return false;
+	Watcher->Watch( FPaths::ProjectConfigDir() );
+	Watcher->Watch( FPaths::Combine( FPaths::ProjectSavedDir(), "Config" ) );
+	Watcher->Watch( FPaths::ProjectPluginsDir() );
 
-	if( !EnsureDirectoryExists( FPaths::GetPath( Destination ) ) )
-		return false;
+	if( !Watcher->IsWatching() )
+		UE_LOG( OmniSync, Warning, TEXT( "Directory watcher unavailable, falling back to polling" ) );
 
-	return PlatformFile.CopyFile( *Destination, *Source );
+	FOmniSyncWorker::FJob Job = []( const FThreadSafeBool& )
+	{
+		bool bSucceeded = true;
+		for( const EOmniSyncScope Scope: { EOmniSyncScope::Global, EOmniSyncScope::PerEngineVersion, EOmniSyncScope::PerProject } )
+			bSucceeded &= EnsureDirectoryExists( GetScopedSettingsDirectory( Scope ) );
+
+		return bSucceeded;
+	};
+
+	GetWorker().Enqueue( MoveTemp( Job ), FOnSyncJobCompleted::CreateUObject( this, &UOmniSyncSettings::WatchScopeDirectories ) );
 }
 
-bool UOmniSyncSettings::EnsureDirectoryExists( const FString& DirectoryPath )
+void UOmniSyncSettings::WatchScopeDirectories( bool bSucceeded )
 {
 	TRACE_CPU_SCOPE;
 
-	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-
-	if( PlatformFile.DirectoryExists( *DirectoryPath ) )
-		return true;
+	if( !Watcher.IsValid() )
+		return;
 
-	return PlatformFile.CreateDirectoryTree( *DirectoryPath );
+	// Other editors may have pushed while this one was closed, the first check catches up with them
+	for( const EOmniSyncScope Scope: { EOmniSyncScope::Global, EOmniSyncScope::PerEngineVersion, EOmniSyncScope::PerProject } )
+	{
+		Watcher->Watch( GetScopedSettingsDirectory( Scope ) );
+		RequestUpstreamPull( Scope );
+	}
 }
 
-FString UOmniSyncSettings::GetScopedSettingsDirectory( const EOmniSyncScope Scope )
+void UOmniSyncSettings::OnWatchedFilesChanged( const TArray< FString >& ChangedFiles )
 {
 	TRACE_CPU_SCOPE;
 
-	static FString UserSettingsDir = FPlatformProcess::UserSettingsDir();
-	FString        BaseDir         = FPaths::Combine( UserSettingsDir, "UnrealEngine", "OmniSync" );
-	switch( Scope )
+	static const FString FullProjectDir = FPaths::ConvertRelativePathToFull( FPaths::ProjectDir() );
+
+	// Resolved per batch rather than cached, a scoped store root must not leave events matched against the previous one
+	const FString FullStoreRoot   = FPaths::ConvertRelativePathToFull( GetStoreRootDirectory() ) + TEXT( "/" );
+	const FString FullScopeDirs[] = {
+		FPaths::ConvertRelativePathToFull( GetScopedSettingsDirectory( EOmniSyncScope::Global ) ) + TEXT( "/" ),
+		FPaths::ConvertRelativePathToFull( GetScopedSettingsDirectory( EOmniSyncScope::PerEngineVersion ) ) + TEXT( "/" ),
+		FPaths::ConvertRelativePathToFull( GetScopedSettingsDirectory( EOmniSyncScope::PerProject ) ) + TEXT( "/" ),
+	};
+
+	for( const FString& ChangedFile: ChangedFiles )
 	{
-		case EOmniSyncScope::Global:
-			return FPaths::Combine( BaseDir, "Global" );
-		case EOmniSyncScope::PerEngineVersion:
+		// Events from the store never push anything, only a scope's generations file queues a pull. Our own pushes change the ini files
+		// there as well, and a store root inside the project must not have its files mistaken for project files
+		if( ChangedFile.StartsWith( FullStoreRoot ) )
 		{
-			static FString EngineVersion = FString::Printf( TEXT( "%d.%d" ), ENGINE_MAJOR_VERSION, ENGINE_MINOR_VERSION );
-			return FPaths::Combine( BaseDir, "PerEngineVersion", EngineVersion );
+			const int32 ScopeIndex = Algo::IndexOfByPredicate( FullScopeDirs, [&ChangedFile]( const FString& ScopeDir ) { return ChangedFile.StartsWith( ScopeDir ); } );
+			if( ScopeIndex != INDEX_NONE && FPaths::GetCleanFilename( ChangedFile ) == FOmniSyncGenerations::FileName )
+				RequestUpstreamPull( static_cast< EOmniSyncScope >( ScopeIndex ) );
+
+			continue;
 		}
-		case EOmniSyncScope::PerProject:
-			return FPaths::Combine( BaseDir, "PerProject", FApp::GetProjectName() );
-		default:
-			return BaseDir;
+
+		if( !ChangedFile.StartsWith( FullProjectDir ) )
+			continue;
+
+		FString RelativePath = ChangedFile;
+		FPaths::MakePathRelativeTo( RelativePath, *FullProjectDir );
+
+		if( !FindSetting( RelativePath ) )
+			continue;
+
+		// Editors tend to write the same file several times in a row, the scheduler waits for the burst to settle
+		GetScheduler().ScheduleFile( RelativePath );
 	}
 }
 
-FString UOmniSyncSettings::GetPluginSettingsFilePath()
+void UOmniSyncSettings::RequestUpstreamPull( const EOmniSyncScope Scope )
 {
 	TRACE_CPU_SCOPE;
-	return FPaths::Combine( GetScopedSettingsDirectory( EOmniSyncScope::PerProject ), "OmniSyncSettings.json" );
+
+	if( !ConfigFileSettingsStruct.bAutoPull )
+		return;
+
+	PendingUpstreamScopes |= 1 << static_cast< uint8 >( Scope );
+
+	// A burst of pushes elsewhere folds into the check that is already queued, another one follows if it already started
+	if( UpstreamJobId == 0 )
+		EnqueueUpstreamPull();
+}
+
+void UOmniSyncSettings::EnqueueUpstreamPull()
+{
+	TRACE_CPU_SCOPE;
+
+	const TSharedRef< const FOmniSyncPlan > Plan      = GetSyncPlan();
+	const uint8                             ScopeMask = PendingUpstreamScopes;
+	PendingUpstreamScopes                             = 0;
+
+	FOmniSyncWorker::FJob Job = [this, Plan, ScopeMask]( const FThreadSafeBool& bCancelled )
+	{
+		const TArray< FOmniSyncPlanEntry >& Entries = Plan->GetEntries();
+
+		TArray< int32 > EntryIndices;
+		{
+			FScopeLock Lock( &SyncLock );
+			for( int32 Index = 0; Index < Entries.Num() && !bCancelled; ++Index )
+			{
+				const FOmniSyncPlanEntry& Entry = Entries[ Index ];
+				if( !EnumHasAnyFlags( Entry.Flags, EOmniSyncPlanFlags::AutoSync ) || !( ScopeMask & Entry.GetScopeMask() ) )
+					continue;
+
+				// Our own pushes recorded the generation they produced, so they never come back here as upstream changes
+				const FOmniSyncManifestEntry* ManifestEntry = GetLocalManifest().Find( Entry.RelativePath );
+				if( GetStoreGeneration( Entry ) > ( ManifestEntry ? ManifestEntry->SyncedGeneration : 0 ) )
+					EntryIndices.Add( Index );
+			}
+		}
+
+		if( EntryIndices.IsEmpty() )
+			return true;
+
+		AsyncTask( ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr< UOmniSyncSettings >( this ), Plan, EntryIndices = MoveTemp( EntryIndices )]() mutable
+		{
+			// The indices belong to this plan, after a settings change the next watcher event or sweep takes over
+			UOmniSyncSettings* Settings = WeakThis.Get();
+			if( Settings && Settings->GetSyncPlan() == Plan )
+				Settings->EnqueueSync( MoveTemp( EntryIndices ), true, true );
+		} );
+
+		return true;
+	};
+
+	UpstreamJobId = GetWorker().Enqueue( MoveTemp( Job ), FOnSyncJobCompleted::CreateWeakLambda( this, [this]( bool )
+	{
+		UpstreamJobId = 0;
+		if( PendingUpstreamScopes != 0 )
+			EnqueueUpstreamPull();
+	} ) );
+}
+
+void UOmniSyncSettings::OnSyncBatchReady( const FOmniSyncBatch& Batch )
+{
+	TRACE_CPU_SCOPE;
+
+	if( Batch.bSaveSettings )
+		SavePluginSettings();
+
+	if( Batch.bAllFiles )
+	{
+		SaveSettingsToGlobal();
+		return;
+	}
+
+	if( Batch.Files.IsEmpty() )
+		return;
+
+	const TSharedRef< const FOmniSyncPlan > Plan = GetSyncPlan();
+
+	TArray< int32 > ChangedEntries;
+	for( const FString& ChangedFile: Batch.Files )
+	{
+		const int32 EntryIndex = Plan->Find( ChangedFile );
+		if( EntryIndex != INDEX_NONE && EnumHasAnyFlags( Plan->GetEntries()[ EntryIndex ].Flags, EOmniSyncPlanFlags::AutoSync ) )
+			ChangedEntries.Add( EntryIndex );
+	}
+
+	if( !ChangedEntries.IsEmpty() )
+		EnqueueSync( MoveTemp( ChangedEntries ), true, true, FOnSyncJobCompleted(), Batch.FirstChangeTime );
+}
+
+FOmniSyncScheduler& UOmniSyncSettings::GetScheduler()
+{
+	if( !Scheduler.IsValid() )
+	{
+		Scheduler = MakeShared< FOmniSyncScheduler >( FOnSyncBatchReady::CreateUObject( this, &UOmniSyncSettings::OnSyncBatchReady ) );
+		Scheduler->SetQuietWindow( ConfigFileSettingsStruct.SyncQuietWindowSeconds );
+		Scheduler->SetMaxDelay( ConfigFileSettingsStruct.SyncMaxDelaySeconds );
+	}
+
+	return *Scheduler;
+}
+
+bool UOmniSyncSettings::PushFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry )
+{
+	TRACE_CPU_SCOPE;
+	FOmniSyncLatencyScope LatencyScope( EOmniSyncOperation::Push );
+
+	if( !SyncFile( Store, Entry, true ) )
+		return false;
+
+	RecordSyncState( Entry );
+	return true;
+}
+
+bool UOmniSyncSettings::PullFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, FOmniSyncPulledFile* OutPulledFile )
+{
+	TRACE_CPU_SCOPE;
+	FOmniSyncLatencyScope LatencyScope( EOmniSyncOperation::Pull );
+
+	if( !SyncFile( Store, Entry, false, OutPulledFile ) )
+		return false;
+
+	RecordSyncState( Entry );
+	return true;
+}
+
+bool UOmniSyncSettings::ReconcileFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, const bool bAllowPull, FOmniSyncPulledFile* OutPulledFile )
+{
+	TRACE_CPU_SCOPE;
+
+	uint64  LocalHash        = 0;
+	uint64  StoreHash        = 0;
+	bool    bLocalExists     = false;
+	bool    bStoreExists     = false;
+	int64   StoreGeneration  = 0;
+	int64   SyncedGeneration = 0;
+	FString SyncedHash;
+	{
+		FScopeLock Lock( &SyncLock );
+		bLocalExists    = GetLocalManifest().GetHash( Entry.RelativePath, Entry.LocalFile, LocalHash );
+		bStoreExists    = Store.GetHash( Entry.Scope, Entry.RelativePath, StoreHash );
+		StoreGeneration = GetStoreGeneration( Entry );
+
+		if( const FOmniSyncManifestEntry* ManifestEntry = GetLocalManifest().Find( Entry.RelativePath ) )
+		{
+			SyncedGeneration = ManifestEntry->SyncedGeneration;
+			SyncedHash       = ManifestEntry->SyncedHash;
+		}
+	}
+
+	// A file another editor pushed that this project does not have yet can only come in, pushing it would fail
+	if( !bLocalExists && bStoreExists )
+		return !bAllowPull || PullFile( Store, Entry, OutPulledFile );
+
+	if( !bLocalExists || !bStoreExists || LocalHash == StoreHash )
+		return PushFile( Store, Entry );
+
+	// Pushing only what changed here since the last sync, and pulling what another editor pushed since, settles two editors in one round
+	const bool bLocalChanged = SyncedHash.IsEmpty() || FOmniSyncManifest::StringToHash( SyncedHash ) != LocalHash;
+	const bool bStoreChanged = StoreGeneration > SyncedGeneration;
+
+	if( !bStoreChanged )
+		return PushFile( Store, Entry );
+
+	// Without auto-pull the newer store copy is left for a manual load, only our own edits still go out
+	if( !bAllowPull )
+		return !bLocalChanged || PushFile( Store, Entry );
+
+	if( !bLocalChanged )
+		return PullFile( Store, Entry, OutPulledFile );
+
+	// Both sides moved, their keys are merged in first and whatever is left of ours goes out afterwards
+	return PullFile( Store, Entry, OutPulledFile ) && PushFile( Store, Entry );
+}
+
+void UOmniSyncSettings::RecordSyncState( const FOmniSyncPlanEntry& Entry )
+{
+	TRACE_CPU_SCOPE;
+
+	FScopeLock Lock( &SyncLock );
+
+	uint64 LocalHash = 0;
+	if( GetLocalManifest().GetHash( Entry.RelativePath, Entry.LocalFile, LocalHash ) )
+		GetLocalManifest().SetSyncState( Entry.RelativePath, GetStoreGeneration( Entry ), LocalHash );
+}
+
+void UOmniSyncSettings::ForgetSyncState( const FOmniSyncPlanEntry& Entry )
+{
+	TRACE_CPU_SCOPE;
+
+	// Without a base or a synced hash the next sync pushes the project copy, which then wins every conflict with the store
+	IFileManager::Get().Delete( *Entry.BaseFile, false, true, true );
+
+	FScopeLock Lock( &SyncLock );
+	GetLocalManifest().ForgetSyncedHash( Entry.RelativePath, GetStoreGeneration( Entry ) );
+}
+
+bool UOmniSyncSettings::SyncFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, const bool bPush, FOmniSyncPulledFile* OutPulledFile )
+{
+	TRACE_CPU_SCOPE;
+
+	const EOmniSyncScope Scope        = Entry.Scope;
+	const FString&       RelativePath = Entry.RelativePath;
+	const FString&       LocalFile    = Entry.LocalFile;
+	const FString&       BaseFile     = Entry.BaseFile;
+
+	TRACE_SYNC_SCOPE( *RelativePath );
+
+	// A base that did not land would make the next merge read our keys as deleted elsewhere, the file is synced again without one instead
+	auto BaseFailed = [&]
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to write the merge base of %s" ), *RelativePath );
+		ForgetSyncState( Entry );
+		return false;
+	};
+
+	uint64 LocalHash    = 0;
+	uint64 StoreHash    = 0;
+	bool   bLocalExists = false;
+	bool   bStoreExists = false;
+	{
+		FScopeLock Lock( &SyncLock );
+		bLocalExists = GetLocalManifest().GetHash( RelativePath, LocalFile, LocalHash );
+		bStoreExists = Store.GetHash( Scope, RelativePath, StoreHash );
+	}
+
+	if( bPush ? !bLocalExists : !bStoreExists )
+		return false;
+
+	if( bLocalExists && bStoreExists && LocalHash == StoreHash )
+	{
+		if( !FPlatformFileManager::Get().GetPlatformFile().FileExists( *BaseFile ) && !CopyIniFile( LocalFile, BaseFile ) )
+			return BaseFailed();
+
+		FOmniSyncStats::AddFileSkipped();
+		return true;
+	}
+
+	TArray< uint8 > LocalBytes;
+	TArray< uint8 > StoreBytes;
+	FString         StoreFile;
+	bool            bReadFailed = bLocalExists && !FFileHelper::LoadFileToArray( LocalBytes, *LocalFile );
+	if( !bReadFailed && bStoreExists )
+	{
+		FScopeLock Lock( &SyncLock );
+
+		// A first pull from a backend that keeps plain files is copied across as a file and only read back from the project
+		if( !bPush && !bLocalExists )
+			StoreFile = Store.GetPlainFile( Scope, RelativePath );
+
+		bReadFailed = StoreFile.IsEmpty() && !Store.Read( Scope, RelativePath, StoreBytes );
+	}
+
+	if( bReadFailed )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to read %s for syncing" ), *RelativePath );
+		return false;
+	}
+
+	// Nothing on the other side yet, so there is nothing to merge with
+	if( bPush ? !bStoreExists : !bLocalExists )
+	{
+		bool bCopied = false;
+		if( bPush )
+			bCopied = WriteToStore( Store, Scope, RelativePath, LocalBytes, LocalHash );
+		else if( !StoreFile.IsEmpty() )
+			bCopied = CopyIniFile( StoreFile, LocalFile ) && FFileHelper::LoadFileToArray( StoreBytes, *LocalFile );
+		else
+			bCopied = WriteIniFile( LocalFile, StoreBytes );
+
+		if( !bCopied )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Failed to copy %s %s the store" ), *RelativePath, bPush ? TEXT( "to" ) : TEXT( "from" ) );
+			return false;
+		}
+
+		// A copied file is hashed as it landed, the store may have moved on since its hash was looked up
+		const TArray< uint8 >& CopiedBytes = bPush ? LocalBytes : StoreBytes;
+		if( !bPush )
+			UpdateLocalManifest( RelativePath, LocalFile, StoreFile.IsEmpty() ? StoreHash : FOmniSyncManifest::HashBuffer( StoreBytes.GetData(), StoreBytes.Num() ) );
+
+		if( !WriteIniFile( BaseFile, CopiedBytes ) )
+			return BaseFailed();
+
+		FOmniSyncStats::AddFileCopied();
+
+		if( OutPulledFile )
+		{
+			OutPulledFile->RelativePath = RelativePath;
+			OutPulledFile->Document.Parse( DecodeIniText( CopiedBytes ) );
+			for( const FOmniSyncIniSection& Section: OutPulledFile->Document.GetSections() )
+			{
+				for( const FOmniSyncIniKey& Key: Section.Keys )
+					OutPulledFile->Changes.Add( { Section.Name, Key.Name } );
+			}
+		}
+
+		return true;
+	}
+
+	FString LocalText = DecodeIniText( LocalBytes );
+	FString StoreText = DecodeIniText( StoreBytes );
+	FString BaseText;
+
+	// Without a base every difference counts as a conflict, which the syncing direction wins
+	const bool bHasBase = FFileHelper::LoadFileToString( BaseText, *BaseFile );
+
+	FOmniSyncIniDocument LocalDocument;
+	FOmniSyncIniDocument StoreDocument;
+	FOmniSyncIniDocument BaseDocument;
+	LocalDocument.Parse( LocalText );
+	StoreDocument.Parse( StoreText );
+	BaseDocument.Parse( BaseText );
+
+	const EOmniSyncMergeWinner   Winner         = bPush ? EOmniSyncMergeWinner::Ours : EOmniSyncMergeWinner::Theirs;
+	FOmniSyncIniDocument         MergedDocument = bPush ? StoreDocument : LocalDocument;
+	TArray< FOmniSyncIniChange > Changes        = FOmniSyncIniMerge::Merge( BaseDocument, LocalDocument, StoreDocument, Winner, MergedDocument );
+
+	FString MergedText = bPush ? MoveTemp( LocalText ) : FString();
+
+	if( !Changes.IsEmpty() )
+	{
+		FString               DestinationText  = MergedDocument.ToString();
+		const TArray< uint8 > DestinationBytes = EncodeIniText( DestinationText );
+		const uint64          DestinationHash  = FOmniSyncManifest::HashBuffer( DestinationBytes.GetData(), DestinationBytes.Num() );
+
+		if( bPush ? !WriteToStore( Store, Scope, RelativePath, DestinationBytes, DestinationHash ) : !WriteIniFile( LocalFile, DestinationBytes ) )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Failed to write merged %s" ), *RelativePath );
+			return false;
+		}
+
+		if( !bPush )
+		{
+			UpdateLocalManifest( RelativePath, LocalFile, DestinationHash );
+			MergedText = MoveTemp( DestinationText );
+		}
+
+		FOmniSyncStats::AddFileCopied();
+		UE_LOG( OmniSync, Verbose, TEXT( "Merged %d changed keys into %s %s" ), Changes.Num(), bPush ? TEXT( "stored" ) : TEXT( "local" ), *RelativePath );
+
+		if( OutPulledFile )
+		{
+			OutPulledFile->RelativePath = RelativePath;
+			OutPulledFile->Document     = MoveTemp( MergedDocument );
+			OutPulledFile->Changes      = MoveTemp( Changes );
+		}
+	}
+	else
+	{
+		if( !bPush )
+			MergedText = MoveTemp( LocalText );
+
+		FOmniSyncStats::AddFileSkipped();
+	}
+
+	// The base tracks the local file as of the last sync, keys it lacks are then recognised as added elsewhere rather than deleted here
+	if( ( !bHasBase || !MergedText.Equals( BaseText, ESearchCase::CaseSensitive ) ) && !WriteIniFile( BaseFile, EncodeIniText( MergedText ) ) )
+		return BaseFailed();
+
+	return true;
+}
+
+FOmniSyncFileReport UOmniSyncSettings::CompareFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, const bool bWithChanges )
+{
+	TRACE_CPU_SCOPE;
+	TRACE_SYNC_SCOPE( *Entry.RelativePath );
+	FOmniSyncLatencyScope LatencyScope( EOmniSyncOperation::Verify );
+
+	FOmniSyncFileReport Report;
+	Report.RelativePath = Entry.RelativePath;
+	Report.Scope        = Entry.Scope;
+
+	uint64 LocalHash    = 0;
+	uint64 StoreHash    = 0;
+	bool   bLocalExists = false;
+	bool   bStoreExists = false;
+	{
+		FScopeLock Lock( &SyncLock );
+		bLocalExists = GetLocalManifest().GetHash( Entry.RelativePath, Entry.LocalFile, LocalHash );
+		bStoreExists = Store.GetHash( Entry.Scope, Entry.RelativePath, StoreHash );
+	}
+
+	if( !bLocalExists || !bStoreExists )
+	{
+		Report.State = bLocalExists ? EOmniSyncFileState::LocalOnly : bStoreExists ? EOmniSyncFileState::StoreOnly : EOmniSyncFileState::Missing;
+		return Report;
+	}
+
+	// A merged view is rebuilt from its layers and never keeps the local formatting, so layered files are compared key by key
+	const bool bLayered = EnumHasAnyFlags( Entry.Flags, EOmniSyncPlanFlags::Layered ) && Entry.Scope != EOmniSyncScope::Global;
+
+	Report.State = LocalHash == StoreHash ? EOmniSyncFileState::InSync : EOmniSyncFileState::Modified;
+	if( Report.State == EOmniSyncFileState::InSync || ( !bWithChanges && !bLayered ) )
+		return Report;
+
+	TArray< uint8 > LocalBytes;
+	TArray< uint8 > StoreBytes;
+	bool            bRead = FFileHelper::LoadFileToArray( LocalBytes, *Entry.LocalFile );
+	if( bRead )
+	{
+		FScopeLock Lock( &SyncLock );
+		bRead = Store.Read( Entry.Scope, Entry.RelativePath, StoreBytes );
+	}
+
+	if( !bRead )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to read %s for comparing" ), *Entry.RelativePath );
+		return Report;
+	}
+
+	FOmniSyncIniDocument LocalDocument;
+	FOmniSyncIniDocument StoreDocument;
+	LocalDocument.Parse( DecodeIniText( LocalBytes ) );
+	StoreDocument.Parse( DecodeIniText( StoreBytes ) );
+
+	// Files that only differ in formatting or comments keep the Modified state with an empty change list
+	TArray< FOmniSyncIniChange > Changes = FOmniSyncIniMerge::Diff( LocalDocument, StoreDocument );
+	if( bLayered && Changes.IsEmpty() )
+		Report.State = EOmniSyncFileState::InSync;
+
+	if( bWithChanges )
+		Report.Changes = MoveTemp( Changes );
+
+	return Report;
+}
+
+bool UOmniSyncSettings::WriteToStore( IOmniSyncStorage& Store, const EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, const uint64 Hash )
+{
+	int32 MaxVersions = 0;
+	int64 MaxBytes    = 0;
+	{
+		FScopeLock Lock( &SyncLock );
+		MaxVersions = HistoryMaxVersions;
+		MaxBytes    = HistoryMaxBytes;
+	}
+
+	// The history is loaded, recompressed and saved outside SyncLock, so parallel jobs only wait for each other on the store itself
+	FScopeLock       HistoryLock( &GetHistoryLock( Scope, RelativePath ) );
+	FOmniSyncHistory History( Scope, RelativePath );
+	const bool       bSeedHistory = MaxVersions > 0 && !History.Load();
+
+	int64           Generation         = 0;
+	int64           PreviousGeneration = 0;
+	bool            bHasPrevious       = false;
+	TArray< uint8 > PreviousBytes;
+	{
+		FScopeLock Lock( &SyncLock );
+
+		// The first write with history enabled also keeps the version it replaces, so that one can be rolled back as well
+		bHasPrevious = bSeedHistory && Store.Read( Scope, RelativePath, PreviousBytes );
+		if( bHasPrevious )
+			PreviousGeneration = GetGenerations( Scope ).Get( RelativePath );
+
+		if( !Store.Write( Scope, RelativePath, Bytes, Hash ) )
+			return false;
+
+		Generation = GetGenerations( Scope ).Bump( RelativePath );
+		FOmniSyncStats::AddBytesWritten( Bytes.Num() );
+	}
+
+	if( MaxVersions > 0 )
+	{
+		if( bHasPrevious )
+			History.Add( PreviousGeneration, PreviousBytes );
+
+		History.Add( Generation, Bytes );
+		History.Trim( MaxVersions, MaxBytes );
+		History.Save();
+	}
+
+	return true;
+}
+
+void UOmniSyncSettings::UpdateLocalManifest( const FString& RelativePath, const FString& LocalFile, const uint64 Hash )
+{
+	FScopeLock Lock( &SyncLock );
+	GetLocalManifest().Update( RelativePath, LocalFile, Hash );
+}
+
+FCriticalSection& UOmniSyncSettings::GetHistoryLock( const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	return HistoryLocks[ HashCombineFast( GetTypeHash( RelativePath ), GetTypeHash( Scope ) ) % UE_ARRAY_COUNT( HistoryLocks ) ];
+}
+
+uint32 UOmniSyncSettings::EnqueueSync( TArray< int32 >&& EntryIndices, const bool bAutoSyncOnly, const bool bPush, const FOnSyncJobCompleted& OnCompleted, const double ChangeTime )
+{
+	TRACE_CPU_SCOPE;
+
+	const TSharedRef< const FOmniSyncPlan > Plan        = GetSyncPlan();
+	const bool                              bHotApply   = ( !bPush || bAutoSyncOnly ) && ConfigFileSettingsStruct.bHotApplyOnLoad;
+	const bool                              bAutoPull   = ConfigFileSettingsStruct.bAutoPull;
+	const EOmniSyncStorageMode              StorageMode = ConfigFileSettingsStruct.StorageMode;
+	const bool                              bCompress   = ConfigFileSettingsStruct.bCompressBlobs;
+
+	// The job shares the immutable plan instead of copying settings, an empty index list stands for every entry
+	FOmniSyncWorker::FJob Job = [this, Plan, EntryIndices = MoveTemp( EntryIndices ), bAutoSyncOnly, bPush, bHotApply, bAutoPull, StorageMode, bCompress, ChangeTime]( const FThreadSafeBool& bCancelled )
+	{
+		FOmniSyncLayeredStorage             Store( GetStorage( StorageMode, bCompress ), *Plan, GetLayerCache() );
+		const TArray< FOmniSyncPlanEntry >& Entries    = Plan->GetEntries();
+		const int32                         NumEntries = EntryIndices.IsEmpty() ? Entries.Num() : EntryIndices.Num();
+
+		// Most files of a batch share a handful of directories, each one is checked once per job
+		FOmniSyncFileCopy::FBatchScope DirectoryCacheScope;
+
+		auto GetEntry = [&]( const int32 Index ) -> const FOmniSyncPlanEntry& { return Entries[ EntryIndices.IsEmpty() ? Index : EntryIndices[ Index ] ]; };
+
+		// Scopes are locked in a fixed order, so two editors never hold one each while waiting for the other's
+		TArray< EOmniSyncScope > Scopes;
+		for( int32 Index = 0; Index < NumEntries; ++Index )
+		{
+			const uint8 ScopeMask = GetEntry( Index ).GetScopeMask();
+			for( uint8 Scope = 0; Scope <= static_cast< uint8 >( EOmniSyncScope::PerProject ); ++Scope )
+			{
+				if( ScopeMask & ( 1 << Scope ) )
+					Scopes.AddUnique( static_cast< EOmniSyncScope >( Scope ) );
+			}
+		}
+		Scopes.Sort();
+
+		// One bit per EOmniSyncScope, a layered file waits for every layer it reads
+		uint8 BusyScopes = 0;
+		for( const EOmniSyncScope Scope: Scopes )
+		{
+			if( GetGenerations( Scope ).TryLock( ScopeLockTimeoutSeconds ) )
+				continue;
+
+			// Automatic syncs retry later, an explicit push or pull still goes through
+			if( bAutoSyncOnly )
+				BusyScopes |= 1 << static_cast< uint8 >( Scope );
+			else
+				UE_LOG( OmniSync, Warning, TEXT( "Syncing %s without its lock, another editor is holding it" ), *UEnum::GetValueAsString( Scope ) );
+		}
+
+		// Every file writes only its own slot, the results are gathered in plan order afterwards
+		TArray< TOptional< bool > >   Outcomes;
+		TArray< FOmniSyncPulledFile > PulledFiles;
+		Outcomes.SetNum( NumEntries );
+		PulledFiles.SetNum( bHotApply ? NumEntries : 0 );
+
+		ParallelFor( NumEntries, [&]( const int32 Index )
+		{
+			const FOmniSyncPlanEntry& Entry = GetEntry( Index );
+			if( bCancelled || ( bAutoSyncOnly && !EnumHasAnyFlags( Entry.Flags, EOmniSyncPlanFlags::AutoSync ) ) || ( BusyScopes & Entry.GetScopeMask() ) )
+				return;
+
+			FOmniSyncPulledFile* PulledFile = bHotApply ? &PulledFiles[ Index ] : nullptr;
+			if( bAutoSyncOnly && bPush )
+				Outcomes[ Index ] = ReconcileFile( Store, Entry, bAutoPull, PulledFile );
+			else
+				Outcomes[ Index ] = bPush ? PushFile( Store, Entry ) : PullFile( Store, Entry, PulledFile );
+		}, GetSyncParallelForFlags() );
+
+		bool              bSucceeded = true;
+		TArray< FString > SyncedFiles;
+		TArray< FString > FailedFiles;
+		TArray< FString > RetryFiles;
+		for( int32 Index = 0; Index < NumEntries; ++Index )
+		{
+			if( !Outcomes[ Index ].IsSet() )
+			{
+				if( !bCancelled && ( BusyScopes & GetEntry( Index ).GetScopeMask() ) && EnumHasAnyFlags( GetEntry( Index ).Flags, EOmniSyncPlanFlags::AutoSync ) )
+					RetryFiles.Add( GetEntry( Index ).RelativePath );
+				continue;
+			}
+
+			( Outcomes[ Index ].GetValue() ? SyncedFiles : FailedFiles ).Add( GetEntry( Index ).RelativePath );
+			bSucceeded &= Outcomes[ Index ].GetValue();
+		}
+
+		PulledFiles.RemoveAll( []( const FOmniSyncPulledFile& PulledFile ) { return PulledFile.Changes.IsEmpty(); } );
+
+		// A batch whose store writes were lost is not synced, its files go out again once the store takes writes
+		if( !FlushStorage( Scopes ) )
+		{
+			for( int32 Index = 0; Index < NumEntries; ++Index )
+			{
+				if( !Outcomes[ Index ].Get( false ) )
+					continue;
+
+				ForgetSyncState( GetEntry( Index ) );
+				if( bAutoSyncOnly )
+					RetryFiles.Add( GetEntry( Index ).RelativePath );
+			}
+
+			FailedFiles.Append( MoveTemp( SyncedFiles ) );
+			SyncedFiles.Empty();
+			bSucceeded = false;
+		}
+
+		SaveManifests();
+
+		for( const EOmniSyncScope Scope: Scopes )
+			GetGenerations( Scope ).Release();
+
+		if( !RetryFiles.IsEmpty() )
+		{
+			AsyncTask( ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr< UOmniSyncSettings >( this ), RetryFiles = MoveTemp( RetryFiles )]
+			{
+				if( UOmniSyncSettings* Settings = WeakThis.Get() )
+				{
+					for( const FString& RetryFile: RetryFiles )
+						Settings->GetScheduler().ScheduleFile( RetryFile );
+				}
+			} );
+		}
+
+		if( ChangeTime > 0.0 && !SyncedFiles.IsEmpty() )
+			FOmniSyncStats::RecordLatency( EOmniSyncOperation::ChangeToStore, FPlatformTime::Seconds() - ChangeTime );
+
+		if( !SyncedFiles.IsEmpty() || !FailedFiles.IsEmpty() )
+		{
+			AsyncTask( ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr< UOmniSyncSettings >( this ), SyncedFiles = MoveTemp( SyncedFiles ), FailedFiles = MoveTemp( FailedFiles )]
+			{
+				if( UOmniSyncSettings* Settings = WeakThis.Get() )
+					Settings->FilesSyncedEvent.Broadcast( SyncedFiles, FailedFiles );
+			} );
+		}
+
+		if( !PulledFiles.IsEmpty() )
+			AsyncTask( ENamedThreads::GameThread, [PulledFiles = MoveTemp( PulledFiles )] { FOmniSyncConfigApplier::Apply( PulledFiles ); } );
+
+		return bSucceeded;
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ), OnCompleted );
+}
+
+uint32 UOmniSyncSettings::VerifyWithGlobal( const bool bWithChanges, const FOnVerifyCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+
+	const TSharedRef< const FOmniSyncPlan > Plan        = GetSyncPlan();
+	const EOmniSyncStorageMode              StorageMode = ConfigFileSettingsStruct.StorageMode;
+	const bool                              bCompress   = ConfigFileSettingsStruct.bCompressBlobs;
+
+	FOmniSyncWorker::FJob Job = [this, Plan, bWithChanges, StorageMode, bCompress, OnCompleted]( const FThreadSafeBool& bCancelled )
+	{
+		FOmniSyncLayeredStorage             Store( GetStorage( StorageMode, bCompress ), *Plan, GetLayerCache() );
+		const TArray< FOmniSyncPlanEntry >& Entries = Plan->GetEntries();
+
+		TArray< FOmniSyncFileReport > Reports;
+		Reports.SetNum( Entries.Num() );
+
+		ParallelFor( Entries.Num(), [&]( const int32 Index )
+		{
+			if( !bCancelled )
+				Reports[ Index ] = CompareFile( Store, Entries[ Index ], bWithChanges );
+		}, GetSyncParallelForFlags() );
+
+		// Comparing refreshes stale hashes in the manifests, which the next sync can reuse
+		SaveManifests();
+
+		if( bCancelled )
+			return false;
+
+		AsyncTask( ENamedThreads::GameThread, [OnCompleted, Reports = MoveTemp( Reports )] { OnCompleted.ExecuteIfBound( Reports ); } );
+		return true;
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ) );
+}
+
+void UOmniSyncSettings::WaitUntilIdle()
+{
+	TRACE_CPU_SCOPE;
+
+	if( Worker.IsValid() )
+		Worker->WaitUntilIdle();
+}
+
+uint32 UOmniSyncSettings::LoadHistory( const FString& RelativePath, const FOnHistoryLoaded& OnLoaded )
+{
+	TRACE_CPU_SCOPE;
+
+	const FConfigFileSettings* Setting = FindSetting( RelativePath );
+	if( !Setting )
+	{
+		OnLoaded.ExecuteIfBound( {} );
+		return 0;
+	}
+
+	FOmniSyncWorker::FJob Job = [this, Scope = Setting->SettingsScope, StoredPath = Setting->RelativePath, OnLoaded]( const FThreadSafeBool& )
+	{
+		TArray< FOmniSyncHistoryVersion > Versions;
+		{
+			FScopeLock       HistoryLock( &GetHistoryLock( Scope, StoredPath ) );
+			FOmniSyncHistory History( Scope, StoredPath );
+			History.Load();
+			Versions = History.GetVersions();
+		}
+
+		AsyncTask( ENamedThreads::GameThread, [OnLoaded, Versions = MoveTemp( Versions )] { OnLoaded.ExecuteIfBound( Versions ); } );
+		return true;
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ) );
+}
+
+uint32 UOmniSyncSettings::RestoreVersion( const FString& RelativePath, const int64 Version, const FOnSyncJobCompleted& OnCompleted )
+{
+	TRACE_CPU_SCOPE;
+
+	const TSharedRef< const FOmniSyncPlan > Plan       = GetSyncPlan();
+	const int32                             EntryIndex = Plan->Find( NormalizeRelativePath( RelativePath ) );
+	if( EntryIndex == INDEX_NONE )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Cannot restore %s, it is not synced" ), *RelativePath );
+		OnCompleted.ExecuteIfBound( false );
+		return 0;
+	}
+
+	const bool                 bHotApply   = ConfigFileSettingsStruct.bHotApplyOnLoad;
+	const EOmniSyncStorageMode StorageMode = ConfigFileSettingsStruct.StorageMode;
+	const bool                 bCompress   = ConfigFileSettingsStruct.bCompressBlobs;
+
+	// Restoring writes the old content as a new version to the store and the project, so the restore itself can be undone the same way
+	FOmniSyncWorker::FJob Job = [this, Plan, EntryIndex, Version, bHotApply, StorageMode, bCompress]( const FThreadSafeBool& bCancelled )
+	{
+		const FOmniSyncPlanEntry& Entry = Plan->GetEntries()[ EntryIndex ];
+		FOmniSyncLayeredStorage   Store( GetStorage( StorageMode, bCompress ), *Plan, GetLayerCache() );
+
+		TArray< uint8 > Bytes;
+		{
+			FScopeLock       HistoryLock( &GetHistoryLock( Entry.Scope, Entry.RelativePath ) );
+			FOmniSyncHistory History( Entry.Scope, Entry.RelativePath );
+			if( !History.Load() || !History.Restore( Version, Bytes ) )
+			{
+				UE_LOG( OmniSync, Warning, TEXT( "Version %lld of %s is not in its history" ), Version, *Entry.RelativePath );
+				return false;
+			}
+		}
+
+		if( bCancelled )
+			return false;
+
+		if( !GetGenerations( Entry.Scope ).TryLock( ScopeLockTimeoutSeconds ) )
+			UE_LOG( OmniSync, Warning, TEXT( "Restoring %s without its lock, another editor is holding it" ), *Entry.RelativePath );
+
+		FString PreviousText;
+		FFileHelper::LoadFileToString( PreviousText, *Entry.LocalFile );
+
+		const uint64 Hash       = FOmniSyncManifest::HashBuffer( Bytes.GetData(), Bytes.Num() );
+		bool         bSucceeded = WriteToStore( Store, Entry.Scope, Entry.RelativePath, Bytes, Hash ) && WriteIniFile( Entry.LocalFile, Bytes );
+		if( bSucceeded )
+		{
+			UpdateLocalManifest( Entry.RelativePath, Entry.LocalFile, Hash );
+			if( WriteIniFile( Entry.BaseFile, Bytes ) )
+			{
+				RecordSyncState( Entry );
+			}
+			else
+			{
+				UE_LOG( OmniSync, Warning, TEXT( "Failed to write the merge base of %s" ), *Entry.RelativePath );
+				ForgetSyncState( Entry );
+				bSucceeded = false;
+			}
+		}
+
+		// The project already holds the restored file, it is pushed again by the next sync if the store lost it
+		if( !FlushStorage( MakeArrayView( &Entry.Scope, 1 ) ) && bSucceeded )
+		{
+			ForgetSyncState( Entry );
+			bSucceeded = false;
+		}
+
+		SaveManifests();
+		GetGenerations( Entry.Scope ).Release();
+
+		if( !bSucceeded )
+		{
+			UE_LOG( OmniSync, Warning, TEXT( "Failed to restore version %lld of %s" ), Version, *Entry.RelativePath );
+			return false;
+		}
+
+		UE_LOG( OmniSync, Log, TEXT( "Restored version %lld of %s" ), Version, *Entry.RelativePath );
+
+		TArray< FOmniSyncPulledFile > PulledFiles;
+		if( bHotApply )
+		{
+			FOmniSyncIniDocument PreviousDocument;
+			PreviousDocument.Parse( PreviousText );
+
+			FOmniSyncPulledFile& PulledFile = PulledFiles.AddDefaulted_GetRef();
+			PulledFile.RelativePath         = Entry.RelativePath;
+			PulledFile.Document.Parse( DecodeIniText( Bytes ) );
+			PulledFile.Changes = FOmniSyncIniMerge::Diff( PreviousDocument, PulledFile.Document );
+		}
+
+		AsyncTask( ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr< UOmniSyncSettings >( this ), RestoredFile = Entry.RelativePath, PulledFiles = MoveTemp( PulledFiles )]
+		{
+			if( !PulledFiles.IsEmpty() && !PulledFiles[ 0 ].Changes.IsEmpty() )
+				FOmniSyncConfigApplier::Apply( PulledFiles );
+
+			if( UOmniSyncSettings* Settings = WeakThis.Get() )
+				Settings->FilesSyncedEvent.Broadcast( { RestoredFile }, {} );
+		} );
+
+		return true;
+	};
+
+	return GetWorker().Enqueue( MoveTemp( Job ), OnCompleted );
+}
+
+TSharedRef< const FOmniSyncPlan > UOmniSyncSettings::GetSyncPlan()
+{
+	// Rebuilt only after the settings changed, ticks and batches reuse the resolved paths
+	if( bSyncPlanDirty || !SyncPlan.IsValid() )
+	{
+		SyncPlan       = FOmniSyncPlan::Build( ConfigFileSettingsStruct.Settings, *GetPathRules() );
+		bSyncPlanDirty = false;
+	}
+
+	return SyncPlan.ToSharedRef();
+}
+
+TSharedRef< const FOmniSyncPathRules > UOmniSyncSettings::GetPathRules()
+{
+	if( !PathRules.IsValid() )
+		PathRules = FOmniSyncPathRules::Compile( ConfigFileSettingsStruct.ExcludePaths, ConfigFileSettingsStruct.IncludePaths );
+
+	return PathRules.ToSharedRef();
+}
+
+FOmniSyncWorker& UOmniSyncSettings::GetWorker()
+{
+	if( !Worker.IsValid() )
+		Worker = MakeShared< FOmniSyncWorker >();
+
+	return *Worker;
+}
+
+FOmniSyncManifest& UOmniSyncSettings::GetLocalManifest()
+{
+	if( !LocalManifest.IsValid() )
+	{
+		LocalManifest = MakeShared< FOmniSyncManifest >( FPaths::Combine( GetScopedSettingsDirectory( EOmniSyncScope::PerProject ), "OmniSyncLocalManifest.json" ) );
+		LocalManifest->Load();
+	}
+
+	return *LocalManifest;
+}
+
+FOmniSyncGenerations& UOmniSyncSettings::GetGenerations( const EOmniSyncScope Scope )
+{
+	if( FOmniSyncGenerations* Redirected = ScopeRedirects[ static_cast< uint8 >( Scope ) ].Generations )
+		return *Redirected;
+
+	TSharedPtr< FOmniSyncGenerations >& ScopeGenerations = Generations.FindOrAdd( Scope );
+	if( !ScopeGenerations.IsValid() )
+		ScopeGenerations = MakeShared< FOmniSyncGenerations >( GetScopedSettingsDirectory( Scope ) );
+
+	return *ScopeGenerations;
+}
+
+int64 UOmniSyncSettings::GetStoreGeneration( const FOmniSyncPlanEntry& Entry )
+{
+	// Generations only ever grow, so the sum over the layers of a layered file moves whenever any one of them does
+	int64       Generation = 0;
+	const uint8 ScopeMask  = Entry.GetScopeMask();
+	for( uint8 Scope = 0; Scope <= static_cast< uint8 >( EOmniSyncScope::PerProject ); ++Scope )
+	{
+		if( ScopeMask & ( 1 << Scope ) )
+			Generation += GetGenerations( static_cast< EOmniSyncScope >( Scope ) ).Get( Entry.RelativePath );
+	}
+
+	return Generation;
+}
+
+FOmniSyncLayerCache& UOmniSyncSettings::GetLayerCache()
+{
+	// Only touched through the store, which the jobs already serialize on SyncLock
+	if( !LayerCache.IsValid() )
+		LayerCache = MakeShared< FOmniSyncLayerCache >();
+
+	return *LayerCache;
+}
+
+IOmniSyncStorage& UOmniSyncSettings::GetStorage( const EOmniSyncStorageMode Mode, const bool bCompress )
+{
+	if( Storage.IsValid() && ActiveStorageMode == Mode && bActiveStorageCompressed == bCompress )
+		return *Storage;
+
+	if( Storage.IsValid() )
+		Storage->Flush();
+
+	Storage                  = MakeStorage( Mode, bCompress );
+	ActiveStorageMode        = Mode;
+	bActiveStorageCompressed = bCompress;
+	return *Storage;
+}
+
+bool UOmniSyncSettings::FlushStorage( const TConstArrayView< EOmniSyncScope > Scopes )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !Storage.IsValid() || Storage->Flush() )
+		return true;
+
+	// Other editors would otherwise see the new generations, read the old content and record it as synced
+	for( const EOmniSyncScope Scope: Scopes )
+		GetGenerations( Scope ).DiscardBumps();
+
+	return false;
+}
+
+void UOmniSyncSettings::SaveManifests()
+{
+	TRACE_CPU_SCOPE;
+
+	if( LocalManifest.IsValid() )
+		LocalManifest->Save();
+
+	if( Storage.IsValid() )
+		Storage->Flush();
+}
+
+bool UOmniSyncSettings::CopyIniFile( const FString& Source, const FString& Destination )
+{
+	TRACE_CPU_SCOPE;
+	return FOmniSyncFileCopy::Copy( Source, Destination );
+}
+
+bool UOmniSyncSettings::WriteIniFile( const FString& File, const TArray< uint8 >& Bytes )
+{
+	TRACE_CPU_SCOPE;
+
+	if( !EnsureDirectoryExists( FPaths::GetPath( File ) ) )
+		return false;
+
+	// Written next to the file and moved over it, a crash or a full disk never leaves a half written ini behind
+	const FString TempFile = FString::Printf( TEXT( "%s.%s.tmp" ), *File, *FGuid::NewGuid().ToString() );
+	if( !FFileHelper::SaveArrayToFile( Bytes, *TempFile ) )
+	{
+		// The cached directory may have been removed since, it is checked once more before giving up
+		FOmniSyncFileCopy::ForgetDirectory( FPaths::GetPath( File ) );
+		if( !EnsureDirectoryExists( FPaths::GetPath( File ) ) || !FFileHelper::SaveArrayToFile( Bytes, *TempFile ) )
+		{
+			IFileManager::Get().Delete( *TempFile, false, false, true );
+			return false;
+		}
+	}
+
+	if( !IFileManager::Get().Move( *File, *TempFile, true, true ) )
+	{
+		UE_LOG( OmniSync, Warning, TEXT( "Failed to replace %s" ), *File );
+		IFileManager::Get().Delete( *TempFile, false, false, true );
+		return false;
+	}
+
+	FOmniSyncStats::AddBytesWritten( Bytes.Num() );
+	return true;
+}
+
+TArray< uint8 > UOmniSyncSettings::EncodeIniText( const FString& Text )
+{
+	TRACE_CPU_SCOPE;
+
+	// Written as UTF-8 so the bytes hashed for the store match what ends up on disk
+	const FTCHARToUTF8 Converted( *Text, Text.Len() );
+	return TArray< uint8 >( reinterpret_cast< const uint8* >( Converted.Get() ), Converted.Length() );
+}
+
+FString UOmniSyncSettings::DecodeIniText( const TArray< uint8 >& Bytes )
+{
+	TRACE_CPU_SCOPE;
+
+	FString Text;
+	FFileHelper::BufferToString( Text, Bytes.GetData(), Bytes.Num() );
+	return Text;
+}
+
+bool UOmniSyncSettings::EnsureDirectoryExists( const FString& DirectoryPath )
+{
+	TRACE_CPU_SCOPE;
+	return FOmniSyncFileCopy::EnsureDirectory( DirectoryPath );
+}
+
+FString UOmniSyncSettings::GetStoreRootDirectory()
+{
+	TRACE_CPU_SCOPE;
+
+	if( IsStoreRootScoped() )
+		return ScopedStoreRoot;
+
+	// CI runs point the whole module at a throwaway store with -OmniSyncStoreRoot=<Directory>
+	static const FString StoreRootDir = []
+	{
+		FString OverrideDir;
+		if( FParse::Value( FCommandLine::Get(), TEXT( "OmniSyncStoreRoot=" ), OverrideDir ) && !OverrideDir.IsEmpty() )
+			return FPaths::ConvertRelativePathToFull( OverrideDir );
+
+		return FPaths::Combine( FPlatformProcess::UserSettingsDir(), TEXT( "UnrealEngine" ), TEXT( "OmniSync" ) );
+	}();
+
+	return StoreRootDir;
+}
+
+FString UOmniSyncSettings::GetScopedSettingsDirectory( const EOmniSyncScope Scope )
+{
+	TRACE_CPU_SCOPE;
+
+	if( const FString* Redirected = ScopeRedirects[ static_cast< uint8 >( Scope ) ].Directory )
+		return *Redirected;
+
+	// A scoped store root is only checked before the cached directories, so they never capture it
+	if( IsStoreRootScoped() )
+		return MakeScopeDirectory( ScopedStoreRoot, Scope );
+
+	static const FString BaseDir          = GetStoreRootDirectory();
+	static const FString GlobalDir        = MakeScopeDirectory( BaseDir, EOmniSyncScope::Global );
+	static const FString EngineVersionDir = MakeScopeDirectory( BaseDir, EOmniSyncScope::PerEngineVersion );
+	static const FString ProjectDir       = MakeScopeDirectory( BaseDir, EOmniSyncScope::PerProject );
+
+	switch( Scope )
+	{
+		case EOmniSyncScope::Global:
+			return GlobalDir;
+		case EOmniSyncScope::PerEngineVersion:
+			return EngineVersionDir;
+		case EOmniSyncScope::PerProject:
+			return ProjectDir;
+		default:
+			return BaseDir;
+	}
+}
+
+FString UOmniSyncSettings::GetBaseFilePath( const EOmniSyncScope Scope, const FString& RelativePath )
+{
+	TRACE_CPU_SCOPE;
+
+	const FString ScopeName = StaticEnum< EOmniSyncScope >()->GetNameStringByValue( static_cast< int64 >( Scope ) );
+	if( IsStoreRootScoped() )
+		return FPaths::Combine( ScopedStoreRoot, "Bases", FApp::GetProjectName(), ScopeName, RelativePath );
+
+	// Bases live outside the watched scope directories and are kept per project, each project merges against its own last sync
+	static const FString BasesDir = FPaths::Combine( GetStoreRootDirectory(), "Bases", FApp::GetProjectName() );
+	return FPaths::Combine( BasesDir, ScopeName, RelativePath );
+}
+
+FString UOmniSyncSettings::GetPluginSettingsFilePath()
+{
+	TRACE_CPU_SCOPE;
+	return FPaths::Combine( GetScopedSettingsDirectory( EOmniSyncScope::PerProject ), "OmniSyncSettings.json" );
+}
+
+FString UOmniSyncSettings::GetDirectoryIndexFilePath()
+{
+	TRACE_CPU_SCOPE;
+	return FPaths::Combine( GetScopedSettingsDirectory( EOmniSyncScope::PerProject ), "OmniSyncDirectoryIndex.json" );
 }
 
-UOmniSyncSettings* UOmniSyncSettings::Instance = nullptr;
\ No newline at end of file
+UOmniSyncSettings* UOmniSyncSettings::Instance = nullptr;
+FString            UOmniSyncSettings::ScopedStoreRoot;
\ No newline at end of file
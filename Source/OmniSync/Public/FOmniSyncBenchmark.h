@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FOmniSyncDiscovery.h"
+
+class UOmniSyncSettings;
+
+struct FOmniSyncBenchmarkResult
+{
+	FString          Operation;
+	int32            NumFiles = 0;
+	TArray< double > SamplesMs;
+	TArray< int64 >  MemorySamplesBytes;
+};
+
+struct FOmniSyncBenchmarkRegression
+{
+	FString Operation;
+	int32   NumFiles         = 0;
+	double  BaselineMedianMs = 0.0;
+	double  MedianMs         = 0.0;
+};
+
+// Points the store at another directory while it lives. The editor's own jobs are waited for first, and they cannot queue new ones
+// while the caller holds the game thread
+class FOmniSyncScopedStoreRoot
+{
+public:
+	explicit FOmniSyncScopedStoreRoot( const FString& Directory );
+	~FOmniSyncScopedStoreRoot();
+
+private:
+	FString PreviousRoot;
+};
+
+// A settings object over a synthetic project tree under Saved/OmniSyncBenchmark, with its own settings state and a throwaway store
+// next to the tree. Game thread only, the tree is deleted again when the sandbox goes away
+class FOmniSyncSandbox
+{
+public:
+	explicit FOmniSyncSandbox( int32 InNumFiles );
+	~FOmniSyncSandbox();
+
+	UOmniSyncSettings& GetSettings() const { return *Settings; }
+	const FString&     GetRoot() const { return Root; }
+	int32              GetNumFiles() const { return NumFiles; }
+	FString            GetLocalFile( int32 Index ) const;
+	FString            GetRelativePath( int32 Index ) const;
+
+	void Discover();
+	void EnableAll();
+	void SaveSettings();
+	void LoadSettings();
+	void Push();
+	void Pull();
+	void Tick();
+	void WaitUntilIdle();
+
+private:
+	FString                                Root;
+	int32                                  NumFiles = 0;
+	TArray< FOmniSyncDiscoveryRoot >       Roots;
+	TUniquePtr< FOmniSyncScopedStoreRoot > StoreRoot;
+	UOmniSyncSettings*                     Settings = nullptr;
+};
+
+class FOmniSyncBenchmark
+{
+public:
+	static TArray< FOmniSyncBenchmarkResult > Run( const TArray< int32 >& Sizes, int32 Iterations );
+	static bool                               WriteJson( const TArray< FOmniSyncBenchmarkResult >& Results, int32 Iterations, const FString& File );
+
+	// Operations whose median grew past Tolerance times the baseline median, and by more than a millisecond so timer noise on tiny
+	// operations does not count. False when the baseline cannot be read
+	static bool FindRegressions( const TArray< FOmniSyncBenchmarkResult >& Results,
+	                             const FString&                            BaselineFile,
+	                             double                                    Tolerance,
+	                             TArray< FOmniSyncBenchmarkRegression >&   OutRegressions );
+
+	static FString GetDefaultBaselineFile();
+
+private:
+	static void RunSize( int32 NumFiles, int32 Iterations, TArray< FOmniSyncBenchmarkResult >& OutResults );
+	static void Measure( FOmniSyncBenchmarkResult& Result, TFunctionRef< void() > Operation );
+};
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IOmniSyncStorage.h"
+
+class FOmniSyncManifest;
+
+class FOmniSyncBlobStorage : public IOmniSyncStorage
+{
+public:
+	explicit FOmniSyncBlobStorage( const bool bInCompress )
+		: bCompress( bInCompress )
+	{}
+
+	virtual bool              GetHash( EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash ) override;
+	virtual bool              Read( EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes ) override;
+	virtual bool              Write( EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash ) override;
+	virtual bool              Flush() override;
+	virtual TArray< FString > GetRelativePaths( EOmniSyncScope Scope ) override;
+
+	static FString GetBlobsDirectory();
+	static FString GetBlobPath( uint64 Hash );
+
+	// Deletes blobs that no blob manifest of any scope, engine version or project references, returns INDEX_NONE when a manifest is unreadable
+	static int32 CollectGarbage();
+
+	static void EncodeBlob( const TArray< uint8 >& Bytes, bool bCompressPayload, TArray< uint8 >& OutBlob );
+	static bool DecodeBlob( const TArray< uint8 >& Blob, TArray< uint8 >& OutBytes );
+
+private:
+	FOmniSyncManifest& GetManifest( EOmniSyncScope Scope );
+
+	bool bCompress;
+
+	TMap< EOmniSyncScope, TSharedPtr< FOmniSyncManifest > > Manifests;
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UOmniSyncSettings.h"
+
+class IOmniSyncStorage;
+
+class FOmniSyncBundle
+{
+public:
+	using FReadStorage = TFunctionRef< void( IOmniSyncStorage& Storage ) >;
+
+	// Runs Read with a storage over one scope directory of the store, which may belong to another engine version or project
+	using FVisitDirectory = TFunctionRef< void( EOmniSyncScope Scope, const FString& Directory, FReadStorage Read ) >;
+	using FWriteFile      = TFunctionRef< bool( EOmniSyncScope Scope, const FString& Directory, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash ) >;
+
+	static bool Export( FVisitDirectory VisitDirectory, const FString& File, int32* OutFileCount = nullptr );
+	static bool Import( const FString& File, FWriteFile WriteFile, int32* OutFileCount = nullptr );
+
+	// Every directory of the scope in the store, this editor's first. Global has one, the others one per engine version or project
+	static TArray< FString > FindScopeDirectories( EOmniSyncScope Scope );
+
+	// Bundles come from other machines, only plain .ini paths below the scope directory are accepted from them
+	static bool IsSafeRelativePath( const FString& RelativePath );
+	static bool IsSafeDirectoryName( const FString& Name );
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FOmniSyncIni.h"
+
+class FConfigFile;
+
+struct FOmniSyncPulledFile
+{
+	FString                      RelativePath;
+	FOmniSyncIniDocument         Document;
+	TArray< FOmniSyncIniChange > Changes;
+};
+
+class FOmniSyncConfigApplier
+{
+public:
+	static int32 Apply( const TArray< FOmniSyncPulledFile >& PulledFiles );
+
+	static FString GetBranchName( const FString& RelativePath );
+	static bool    IsInReloadedHierarchy( const FString& RelativePath );
+
+private:
+	static bool ApplyKey( const FString& Filename, const FConfigFile& Layers, const FOmniSyncPulledFile& PulledFile, const FOmniSyncIniChange& Change );
+	static void ReloadClasses( FName BranchName, const TSet< FString >& Sections );
+};
\ No newline at end of file
@@ -1,16 +1,48 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "FOmniSyncSearchIndex.h"
 #include "IDetailCustomization.h"
+#include "UOmniSyncSettings.h"
 
 class IDetailLayoutBuilder;
-class UOmniSyncSettings;
 
 struct FPropertyHandles
 {
 	TSharedPtr< IPropertyHandle > EnabledHandle;
 	TSharedPtr< IPropertyHandle > ScopeHandle;
 	TSharedPtr< IPropertyHandle > AutoSyncHandle;
+	TSharedPtr< IPropertyHandle > LayeredHandle;
+};
+
+enum class EConfigRowStatus : uint8
+{
+	None,
+	Synced,
+	Failed,
+};
+
+struct FConfigRowViewModel
+{
+	FPropertyHandles Handles;
+	int32            SettingsIndex = INDEX_NONE;
+
+	// Plain copies of the entry and its last sync result, rows read these while painting instead of querying the handles
+	bool             bEnabled  = false;
+	bool             bAutoSync = false;
+	bool             bLayered  = false;
+	EOmniSyncScope   Scope     = EOmniSyncScope::PerEngineVersion;
+	EConfigRowStatus Status    = EConfigRowStatus::None;
+
+	FText        ScopeText;
+	FText        SyncModeText;
+	FText        StatusText;
+	FLinearColor ScopeColor;
+	FLinearColor SyncModeColor;
+	FLinearColor StatusColor;
+
+	void Update( const FConfigFileSettings& Setting );
+	void SetStatus( EConfigRowStatus NewStatus );
 };
 
 struct FConfigTreeItem
@@ -20,7 +52,17 @@ struct FConfigTreeItem
 	bool    bIsFolder   = false;
 	bool    bIsSettings = false;
 
-	TSharedPtr< FPropertyHandles > PropertyHandles = nullptr;
+	// Folders cover a range of the visible entries and files point at their settings element, children are built on demand
+	int32 FirstEntry     = 0;
+	int32 EndEntry       = 0;
+	int32 SettingsIndex  = INDEX_NONE;
+	bool  bChildrenBuilt = false;
+
+	// Folder checkbox state, recounted only after the customization's revision moved on
+	ECheckBoxState CheckState         = ECheckBoxState::Unchecked;
+	uint32         CheckStateRevision = 0;
+
+	TSharedPtr< FConfigRowViewModel > ViewModel = nullptr;
 
 	TArray< TSharedRef< FConfigTreeItem > > Children;
 };
@@ -30,15 +72,43 @@ class FOmniSyncCustomization : public IDetailCustomization
 public:
 	static TSharedRef< IDetailCustomization > MakeInstance() { return MakeShareable( new FOmniSyncCustomization ); }
 
+	virtual ~FOmniSyncCustomization() override;
+
 	virtual void CustomizeDetails( IDetailLayoutBuilder& DetailBuilder ) override;
 
 private:
 	void RefreshTreeData( const IDetailLayoutBuilder& DetailBuilder );
+	void RebuildRootItems();
+	void BuildChildren( int32 FirstEntry, int32 EndEntry, int32 PrefixLength, TArray< TSharedRef< FConfigTreeItem > >& OutItems );
+	void ExpandAll( const TArray< TSharedRef< FConfigTreeItem > >& Items );
 
-	TSharedRef< ITableRow > OnGenerateRow( TSharedRef< FConfigTreeItem > InItem, const TSharedRef< STableViewBase >& OwnerTable ) const;
-	void                    OnGetChildren( TSharedRef< FConfigTreeItem > InItem, TArray< TSharedRef< FConfigTreeItem > >& OutChildren ) { OutChildren = InItem->Children; }
+	TSharedRef< FConfigTreeItem > MakeFileItem( int32 SortedIndex );
+	void                          RefreshViewModel( FConfigRowViewModel& ViewModel );
+	ECheckBoxState                GetFolderCheckState( FConfigTreeItem& Folder ) const;
+	void                          SetFolderEnabled( const FConfigTreeItem& Folder, bool bEnabled );
+	void                          OnFilterTextChanged( const FText& Text );
+	void                          OnFilesSynced( const TArray< FString >& SyncedFiles, const TArray< FString >& FailedFiles );
+	TSharedRef< SWidget >         MakeHistoryMenu( const FString& RelativePath );
+	TSharedRef< SWidget >         MakeHistoryEntries( const FString& RelativePath, const TArray< FOmniSyncHistoryVersion >& Versions );
+
+	TSharedRef< ITableRow > OnGenerateRow( TSharedRef< FConfigTreeItem > InItem, const TSharedRef< STableViewBase >& OwnerTable );
+	void                    OnGetChildren( TSharedRef< FConfigTreeItem > InItem, TArray< TSharedRef< FConfigTreeItem > >& OutChildren );
 
 	TWeakObjectPtr< UOmniSyncSettings >                      ConfigObject;
+	TSharedPtr< IPropertyHandle >                            SettingsHandle;
 	TSharedPtr< STreeView< TSharedRef< FConfigTreeItem > > > TreeView;
 	TArray< TSharedRef< FConfigTreeItem > >                  RootItems;
+
+	// View models outlive the tree items, keyed by normalized path so filter changes and sync events find them again
+	TMap< FString, TSharedRef< FConfigRowViewModel > > ViewModels;
+	TMap< FString, EConfigRowStatus >                  SyncStatus;
+	uint32                                             Revision = 1;
+	FDelegateHandle                                    FilesSyncedHandle;
+
+	// Settings indices and their normalized paths in tree order, the filter narrows them to the visible entries
+	TArray< int32 >      SortedSettings;
+	TArray< FString >    SortedPaths;
+	TArray< int32 >      VisibleEntries;
+	FOmniSyncSearchIndex SearchIndex;
+	FString              FilterText;
 };
\ No newline at end of file
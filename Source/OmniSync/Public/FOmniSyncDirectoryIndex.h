@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "FOmniSyncDirectoryIndex.generated.h"
+
+USTRUCT()
+struct FOmniSyncDirectoryIndexEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FDateTime Timestamp;
+
+	UPROPERTY()
+	TArray< FString > Files;
+
+	UPROPERTY()
+	TArray< FString > Subdirectories;
+};
+
+USTRUCT()
+struct FOmniSyncDirectoryIndexData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TMap< FString, FOmniSyncDirectoryIndexEntry > Directories;
+};
+
+class FOmniSyncDirectoryIndex
+{
+public:
+	explicit FOmniSyncDirectoryIndex( const FString& InFilePath )
+		: FilePath( InFilePath )
+	{}
+
+	void Load();
+	void Save() const;
+
+	const FOmniSyncDirectoryIndexEntry* Find( const FString& Directory ) const { return Data.Directories.Find( Directory ); }
+
+	void Replace( TMap< FString, FOmniSyncDirectoryIndexEntry >&& Directories );
+
+	int32 Num() const { return Data.Directories.Num(); }
+
+private:
+	FString                     FilePath;
+	FOmniSyncDirectoryIndexData Data;
+};
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FOmniSyncDirectoryIndex.h"
+
+class FOmniSyncPathRules;
+
+struct FOmniSyncDiscoveryRoot
+{
+	FString Directory;
+	bool    bRecursive = true;
+};
+
+struct FOmniSyncDiscoveryStats
+{
+	double Seconds            = 0.0;
+	int32  DirectoriesVisited = 0;
+	int32  DirectoriesPruned  = 0;
+	int32  DirectoriesCached  = 0;
+	int32  FilesFound         = 0;
+
+	FOmniSyncDiscoveryStats& operator+=( const FOmniSyncDiscoveryStats& Other );
+};
+
+class FOmniSyncDiscovery
+{
+public:
+	static TArray< FOmniSyncDiscoveryRoot > GetProjectRoots();
+
+	static TArray< FString > FindConfigFiles( const TArray< FOmniSyncDiscoveryRoot >& Roots,
+	                                          FOmniSyncDiscoveryStats*                OutStats = nullptr,
+	                                          FOmniSyncDirectoryIndex*                Index    = nullptr,
+	                                          const FOmniSyncPathRules*               Rules    = nullptr );
+
+	static void Benchmark( int32 Iterations );
+
+private:
+	struct FWalkContext
+	{
+		const FOmniSyncDirectoryIndex* Index = nullptr;
+		const FOmniSyncPathRules*      Rules = nullptr;
+	};
+
+	struct FWalkResult
+	{
+		TArray< FString >                             Files;
+		TMap< FString, FOmniSyncDirectoryIndexEntry > Directories;
+		FOmniSyncDiscoveryStats                       Stats;
+	};
+
+	static bool        ShouldPruneDirectory( const FString& DirectoryName );
+	static FStringView GetProjectRelativePath( const FString& Path );
+	static void        VisitDirectory( const FString& Directory, TArray< FString >* OutSubdirectories, const FWalkContext& Context, FWalkResult& OutResult );
+	static void        WalkDirectory( const FString& Directory, bool bRecursive, const FWalkContext& Context, FWalkResult& OutResult );
+};
\ No newline at end of file
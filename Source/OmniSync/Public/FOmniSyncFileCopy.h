@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EOmniSyncCopyMethod : uint8
+{
+	Clone,
+	CopyRange,
+	Generic,
+};
+
+class FOmniSyncFileCopy
+{
+public:
+	// Directories seen or created while a batch scope is open are remembered until the outermost scope closes
+	class FBatchScope
+	{
+	public:
+		FBatchScope() { BeginBatch(); }
+		~FBatchScope() { EndBatch(); }
+	};
+
+	static bool Copy( const FString& Source, const FString& Destination, EOmniSyncCopyMethod* OutMethod = nullptr );
+	static bool EnsureDirectory( const FString& Directory );
+	static void ForgetDirectory( const FString& Directory );
+
+private:
+	static void BeginBatch();
+	static void EndBatch();
+
+	static bool CopyNative( const FString& Source, const FString& Destination, EOmniSyncCopyMethod& OutMethod );
+
+	static FRWLock         DirectoryLock;
+	static TSet< FString > KnownDirectories;
+	static int32           BatchDepth;
+};
\ No newline at end of file
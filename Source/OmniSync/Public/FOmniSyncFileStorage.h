@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IOmniSyncStorage.h"
+
+class FOmniSyncManifest;
+
+class FOmniSyncFileStorage : public IOmniSyncStorage
+{
+public:
+	virtual bool              GetHash( EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash ) override;
+	virtual bool              Read( EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes ) override;
+	virtual bool              Write( EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash ) override;
+	virtual bool              Flush() override;
+	virtual TArray< FString > GetRelativePaths( EOmniSyncScope Scope ) override;
+	virtual FString           GetPlainFile( EOmniSyncScope Scope, const FString& RelativePath ) override { return GetFilePath( Scope, RelativePath ); }
+
+	static FString GetFilePath( EOmniSyncScope Scope, const FString& RelativePath );
+
+private:
+	FOmniSyncManifest& GetManifest( EOmniSyncScope Scope );
+
+	TMap< EOmniSyncScope, TSharedPtr< FOmniSyncManifest > > Manifests;
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "FOmniSyncGenerations.generated.h"
+
+USTRUCT()
+struct FOmniSyncGenerationData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TMap< FString, int64 > Generations;
+};
+
+// Generation numbers of the files in one store scope, guarded by an advisory lock file that every editor sharing the scope honours
+class FOmniSyncGenerations
+{
+public:
+	static constexpr const TCHAR* FileName = TEXT( "OmniSyncGenerations.json" );
+
+	explicit FOmniSyncGenerations( const FString& Directory );
+	~FOmniSyncGenerations();
+
+	bool TryLock( double TimeoutSeconds );
+	void Release();
+	bool IsLocked() const { return bLocked; }
+
+	// Touches a held lock at most every few seconds, Get and Bump call it for every file so a long job is not mistaken for a crashed editor
+	void KeepAlive();
+
+	int64 Get( const FString& RelativePath );
+	int64 Bump( const FString& RelativePath );
+
+	// Drops the bumps that were not saved yet, for writes that never reached the store
+	void DiscardBumps();
+
+private:
+	bool TryCreateLockFile();
+	void Refresh( bool bForce = false );
+	void Save();
+
+	FString FilePath;
+	FString LockPath;
+	FString LockToken;
+
+	FOmniSyncGenerationData Data;
+	FDateTime               LoadedTimestamp;
+	FDateTime               LoadedTime;
+	TSet< FString >         DirtyPaths;
+	double                  KeepAliveTime = 0.0;
+	bool                    bLocked       = false;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UOmniSyncSettings.h"
+
+struct FOmniSyncHistoryVersion
+{
+	int64     Version = 0;
+	FDateTime Time;
+	int32     Size = 0;
+};
+
+// Bounded version history of one stored file, oldest first. Versions are zlib-compressed deltas against the one before, with a full
+// keyframe every few versions so restoring any of them decodes a bounded number of records
+class FOmniSyncHistory
+{
+public:
+	FOmniSyncHistory( EOmniSyncScope Scope, const FString& RelativePath );
+
+	bool Load();
+	bool Save() const;
+
+	// Newest first
+	TArray< FOmniSyncHistoryVersion > GetVersions() const;
+
+	void Add( int64 Version, const TArray< uint8 >& Bytes );
+	void Trim( int32 MaxVersions, int64 MaxBytes );
+	bool Restore( int64 Version, TArray< uint8 >& OutBytes ) const;
+
+	static FString GetFilePath( EOmniSyncScope Scope, const FString& RelativePath );
+
+private:
+	struct FRecord
+	{
+		int64           Version   = 0;
+		int64           Ticks     = 0;
+		uint64          Hash      = 0;
+		int32           Size      = 0;
+		bool            bKeyframe = false;
+		TArray< uint8 > Payload;
+
+		friend FArchive& operator<<( FArchive& Archive, FRecord& Record )
+		{
+			return Archive << Record.Version << Record.Ticks << Record.Hash << Record.Size << Record.bKeyframe << Record.Payload;
+		}
+	};
+
+	bool        Decode( int32 Index, TArray< uint8 >& OutBytes ) const;
+	static void Encode( FRecord& Record, const TArray< uint8 >& Bytes, const TArray< uint8 >* Previous );
+
+	static void EncodeDelta( const TArray< uint8 >& Previous, const TArray< uint8 >& Bytes, TArray< uint8 >& OutDelta );
+	static bool ApplyDelta( const TArray< uint8 >& Previous, const TArray< uint8 >& Delta, TArray< uint8 >& OutBytes );
+
+	FString           FilePath;
+	TArray< FRecord > Records;
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FOmniSyncIniKey
+{
+	FString           Name;
+	TArray< FString > Lines;
+	TArray< FString > LeadingComments;
+};
+
+struct FOmniSyncIniSection
+{
+	FString                   Name;
+	TArray< FOmniSyncIniKey > Keys;
+	TArray< FString >         TrailingComments;
+	TMap< FString, int32 >    KeyIndex;
+
+	const FOmniSyncIniKey* FindKey( const FString& Key ) const;
+};
+
+struct FOmniSyncIniChange
+{
+	FString Section;
+	FString Key;
+};
+
+enum class EOmniSyncMergeWinner : uint8
+{
+	Ours,
+	Theirs,
+};
+
+class FOmniSyncIniDocument
+{
+public:
+	void    Parse( const FString& Text );
+	FString ToString() const;
+
+	const TArray< FOmniSyncIniSection >& GetSections() const { return Sections; }
+	const FOmniSyncIniSection*           FindSection( const FString& Section ) const;
+	const TArray< FString >*             FindLines( const FString& Section, const FString& Key ) const;
+
+	void SetLines( const FString& Section, const FString& Key, const TArray< FString >& Lines );
+	void RemoveKey( const FString& Section, const FString& Key );
+
+	static FString GetKeyName( const FString& Line );
+	static bool    LinesEqual( const TArray< FString >* A, const TArray< FString >* B );
+
+private:
+	FOmniSyncIniSection& FindOrAddSection( const FString& Section );
+
+	TArray< FString >             Preamble;
+	TArray< FOmniSyncIniSection > Sections;
+	TMap< FString, int32 >        SectionIndex;
+};
+
+class FOmniSyncIniMerge
+{
+public:
+	static TArray< FOmniSyncIniChange > Merge( const FOmniSyncIniDocument& Base,
+	                                           const FOmniSyncIniDocument& Ours,
+	                                           const FOmniSyncIniDocument& Theirs,
+	                                           EOmniSyncMergeWinner        ConflictWinner,
+	                                           FOmniSyncIniDocument&       Target );
+
+	static TArray< FOmniSyncIniChange > Diff( const FOmniSyncIniDocument& Ours, const FOmniSyncIniDocument& Theirs );
+};
\ No newline at end of file
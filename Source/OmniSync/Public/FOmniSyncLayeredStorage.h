@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FOmniSyncIni.h"
+#include "IOmniSyncStorage.h"
+
+class FOmniSyncPlan;
+
+// Merged views of layered files, each one is rebuilt only when the view below it or its own layer changed
+class FOmniSyncLayerCache
+{
+public:
+	struct FMergedView
+	{
+		uint64               LowerHash = 0;
+		uint64               LayerHash = 0;
+		bool                 bHasLower = false;
+		bool                 bHasLayer = false;
+		FOmniSyncIniDocument Document;
+		TArray< uint8 >      Bytes;
+		uint64               Hash = 0;
+	};
+
+	// Written as the first line of a stored layer that only holds overrides, so projects that do not layer the file still read it whole
+	static constexpr const TCHAR* OverridesMarker = TEXT( "; OmniSync layered overrides, keys not listed here come from the scopes below" );
+
+	const FMergedView* Resolve( IOmniSyncStorage& Store, EOmniSyncScope TopLayer, const FString& RelativePath );
+	bool               IsOverrideLayer( IOmniSyncStorage& Store, EOmniSyncScope Scope, const FString& RelativePath );
+
+private:
+	TMap< TPair< FString, EOmniSyncScope >, FMergedView >           Views;
+	TMap< TPair< FString, EOmniSyncScope >, TPair< uint64, bool > > LayerFormats;
+};
+
+// Presents layered files as Global, then PerEngineVersion, then PerProject merged up to their scope, and stores only the keys a scope overrides
+class FOmniSyncLayeredStorage : public IOmniSyncStorage
+{
+public:
+	FOmniSyncLayeredStorage( IOmniSyncStorage& InStore, const FOmniSyncPlan& InPlan, FOmniSyncLayerCache& InCache );
+
+	virtual bool              GetHash( EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash ) override;
+	virtual bool              Read( EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes ) override;
+	virtual bool              Write( EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash ) override;
+	virtual bool              Flush() override { return Store.Flush(); }
+	virtual TArray< FString > GetRelativePaths( EOmniSyncScope Scope ) override { return Store.GetRelativePaths( Scope ); }
+	virtual FString           GetPlainFile( EOmniSyncScope Scope, const FString& RelativePath ) override;
+
+private:
+	bool IsLayered( EOmniSyncScope Scope, const FString& RelativePath ) const;
+	bool IsStoredAsLayer( EOmniSyncScope Scope, const FString& RelativePath );
+
+	IOmniSyncStorage&    Store;
+	const FOmniSyncPlan& Plan;
+	FOmniSyncLayerCache& Cache;
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "FOmniSyncManifest.generated.h"
+
+USTRUCT()
+struct FOmniSyncManifestEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int64 Size = INDEX_NONE;
+
+	UPROPERTY()
+	FDateTime Timestamp;
+
+	UPROPERTY()
+	FString Hash;
+
+	// When the hash was taken, a file modified within the timestamp granularity of that moment is hashed again
+	UPROPERTY()
+	FDateTime HashTime;
+
+	// Only kept in the project's manifest, the store generation and local hash as of the last sync of the file
+	UPROPERTY()
+	int64 SyncedGeneration = 0;
+
+	UPROPERTY()
+	FString SyncedHash;
+};
+
+USTRUCT()
+struct FOmniSyncManifestData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TMap< FString, FOmniSyncManifestEntry > Entries;
+};
+
+class FOmniSyncManifest
+{
+public:
+	explicit FOmniSyncManifest( const FString& InFilePath )
+		: FilePath( InFilePath )
+	{}
+
+	void Load();
+	bool Save();
+	void Refresh();
+
+	bool GetHash( const FString& RelativePath, const FString& File, uint64& OutHash );
+	void Update( const FString& RelativePath, const FString& File, uint64 Hash );
+
+	const FOmniSyncManifestEntry*                  Find( const FString& RelativePath ) const { return Data.Entries.Find( RelativePath ); }
+	const TMap< FString, FOmniSyncManifestEntry >& GetEntries() const { return Data.Entries; }
+	void                                           Set( const FString& RelativePath, const FOmniSyncManifestEntry& Entry );
+	void                                           SetSyncState( const FString& RelativePath, int64 Generation, uint64 Hash );
+	void                                           ForgetSyncedHash( const FString& RelativePath, int64 Generation );
+
+	static bool   HashFile( const FString& File, uint64& OutHash );
+	static uint64 HashBuffer( const void* Buffer, int64 Size );
+
+	// True while Timestamp is too close to ReadTime for an equal timestamp to prove that the file did not change since
+	static bool IsRacy( const FDateTime& Timestamp, const FDateTime& ReadTime );
+
+	static FString HashToString( const uint64 Hash ) { return FString::Printf( TEXT( "%016llx" ), Hash ); }
+	static uint64  StringToHash( const FString& Hash ) { return FCString::Strtoui64( *Hash, nullptr, 16 ); }
+
+private:
+	void MarkDirty( const FString& RelativePath );
+
+	FString               FilePath;
+	FOmniSyncManifestData Data;
+	FDateTime             LoadedTimestamp;
+	FDateTime             LoadedTime;
+	TSet< FString >       DirtyPaths;
+	bool                  bDirty = false;
+};
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IOmniSyncStorage.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+class FOmniSyncPackStorage : public IOmniSyncStorage
+{
+public:
+	FOmniSyncPackStorage();
+	virtual ~FOmniSyncPackStorage() override;
+
+	virtual bool              GetHash( EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash ) override;
+	virtual bool              Read( EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes ) override;
+	virtual bool              Write( EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash ) override;
+	virtual bool              Flush() override;
+	virtual TArray< FString > GetRelativePaths( EOmniSyncScope Scope ) override;
+
+	static FString GetPackPath( EOmniSyncScope Scope );
+
+private:
+	struct FEntry
+	{
+		FString RelativePath;
+		uint64  Hash   = 0;
+		int64   Offset = 0;
+		int32   Size   = 0;
+	};
+
+	struct FPendingFile
+	{
+		uint64          Hash = 0;
+		TArray< uint8 > Bytes;
+	};
+
+	struct FPack
+	{
+		FString                         File;
+		FDateTime                       Timestamp;
+		FDateTime                       LoadedTime;
+		TArray< FEntry >                Entries;
+		TMap< FString, FPendingFile >   Pending;
+		TUniquePtr< IMappedFileHandle > Handle;
+		TUniquePtr< IMappedFileRegion > Region;
+
+		const FEntry* Find( const FString& RelativePath ) const;
+		void          Unmap();
+	};
+
+	FPack& GetPack( EOmniSyncScope Scope );
+
+	static bool Map( FPack& Pack );
+	static bool Refresh( FPack& Pack );
+	static bool WritePack( FPack& Pack );
+
+	TMap< EOmniSyncScope, TUniquePtr< FPack > > Packs;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Exclude and include globs over project relative paths, compiled once per settings change. Includes only carve files back out of excluded trees
+class FOmniSyncPathRules
+{
+public:
+	static TSharedRef< const FOmniSyncPathRules > Compile( const TArray< FString >& ExcludePatterns, const TArray< FString >& IncludePatterns );
+
+	bool IsEmpty() const { return Excludes.IsEmpty(); }
+
+	// A path is excluded when an exclude matches it or one of its parent directories and no include does
+	bool IsExcluded( FStringView RelativePath ) const;
+
+	// A directory is skipped without enumerating it when it is excluded and no include can match anything below it
+	bool ShouldPruneDirectory( FStringView RelativeDirectory ) const;
+
+private:
+	// Case-insensitive like FString's own hash, but computed over views so lookups of path segments need no string of their own
+	struct FPathKeyFuncs : BaseKeyFuncs< FString, FString, false >
+	{
+		static const FString& GetSetKey( const FString& Element ) { return Element; }
+		static bool           Matches( FStringView A, FStringView B ) { return A.Equals( B, ESearchCase::IgnoreCase ); }
+		static uint32         GetKeyHash( FStringView Key );
+	};
+
+	struct FSegment
+	{
+		FString Text;
+		bool    bAnyDepth = false;
+		bool    bWildcard = false;
+
+		bool Matches( FStringView Name ) const;
+	};
+
+	struct FRuleSet
+	{
+		// Plain paths and plain names are looked up directly, only real globs are matched segment by segment
+		TSet< FString, FPathKeyFuncs > Paths;
+		TSet< FString, FPathKeyFuncs > Names;
+		TArray< TArray< FSegment > >   Globs;
+
+		bool IsEmpty() const { return Paths.IsEmpty() && Names.IsEmpty() && Globs.IsEmpty(); }
+		void Add( const FString& Pattern );
+		bool MatchesSelfOrParent( FStringView Path, TConstArrayView< FStringView > Segments ) const;
+		bool CouldMatchBelow( FStringView Directory, TConstArrayView< FStringView > Segments ) const;
+	};
+
+	static bool MatchesWildcard( FStringView Name, FStringView Pattern );
+	static bool MatchSegments( TConstArrayView< FSegment > Pattern, TConstArrayView< FStringView > Path, bool bPathMayContinue );
+	static void SplitPath( FStringView Path, TArray< FStringView, TInlineAllocator< 16 > >& OutSegments );
+
+	FRuleSet Excludes;
+	FRuleSet Includes;
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UOmniSyncSettings.h"
+
+class FOmniSyncPathRules;
+
+enum class EOmniSyncPlanFlags : uint8
+{
+	None     = 0,
+	AutoSync = 1 << 0,
+	Layered  = 1 << 1,
+};
+
+ENUM_CLASS_FLAGS( EOmniSyncPlanFlags );
+
+struct FOmniSyncPlanEntry
+{
+	FString            RelativePath;
+	FString            LocalFile;
+	FString            BaseFile;
+	EOmniSyncScope     Scope = EOmniSyncScope::PerEngineVersion;
+	EOmniSyncPlanFlags Flags = EOmniSyncPlanFlags::None;
+
+	// Store scopes the entry reads, one bit per EOmniSyncScope, a layered file depends on every layer up to its own
+	uint8 GetScopeMask() const
+	{
+		const uint8 ScopeBit = 1 << static_cast< uint8 >( Scope );
+		return EnumHasAnyFlags( Flags, EOmniSyncPlanFlags::Layered ) ? ( ScopeBit << 1 ) - 1 : ScopeBit;
+	}
+};
+
+class FOmniSyncPlan
+{
+public:
+	static TSharedRef< const FOmniSyncPlan > Build( const TArray< FConfigFileSettings >& Settings, const FOmniSyncPathRules& Rules );
+
+	const TArray< FOmniSyncPlanEntry >& GetEntries() const { return Entries; }
+	int32                               Num( EOmniSyncPlanFlags Flags = EOmniSyncPlanFlags::None ) const;
+	int32                               Find( const FString& NormalizedRelativePath ) const;
+
+private:
+	TArray< FOmniSyncPlanEntry > Entries;
+	TMap< FString, int32 >       EntryIndex;
+	int32                        NumAutoSync = 0;
+};
\ No newline at end of file
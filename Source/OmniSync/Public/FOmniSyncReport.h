@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FOmniSyncIni.h"
+#include "UOmniSyncSettings.h"
+
+enum class EOmniSyncFileState : uint8
+{
+	InSync,
+	Modified,
+	LocalOnly,
+	StoreOnly,
+	Missing,
+};
+
+inline const TCHAR* LexToString( const EOmniSyncFileState State )
+{
+	switch( State )
+	{
+		case EOmniSyncFileState::InSync:
+			return TEXT( "InSync" );
+		case EOmniSyncFileState::Modified:
+			return TEXT( "Modified" );
+		case EOmniSyncFileState::LocalOnly:
+			return TEXT( "LocalOnly" );
+		case EOmniSyncFileState::StoreOnly:
+			return TEXT( "StoreOnly" );
+		default:
+			return TEXT( "Missing" );
+	}
+}
+
+struct FOmniSyncFileReport
+{
+	FString                      RelativePath;
+	EOmniSyncScope               Scope = EOmniSyncScope::PerEngineVersion;
+	EOmniSyncFileState           State = EOmniSyncFileState::Missing;
+	TArray< FOmniSyncIniChange > Changes;
+};
\ No newline at end of file
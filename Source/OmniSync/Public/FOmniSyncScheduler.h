@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+struct FOmniSyncBatch
+{
+	TArray< FString > Files;
+	bool              bAllFiles     = false;
+	bool              bSaveSettings = false;
+
+	// When the oldest file change in the batch was seen, used to time how long changes take to reach the store
+	double FirstChangeTime = 0.0;
+
+	bool IsEmpty() const { return Files.IsEmpty() && !bAllFiles && !bSaveSettings; }
+};
+
+DECLARE_DELEGATE_OneParam( FOnSyncBatchReady, const FOmniSyncBatch& );
+
+class FOmniSyncScheduler
+{
+public:
+	explicit FOmniSyncScheduler( const FOnSyncBatchReady& InOnBatchReady );
+	~FOmniSyncScheduler();
+
+	void SetQuietWindow( float Seconds ) { QuietWindow = FMath::Max( Seconds, 0.0f ); }
+	void SetMaxDelay( float Seconds ) { MaxDelay = FMath::Max( Seconds, QuietWindow ); }
+
+	void ScheduleFile( const FString& RelativePath );
+	void ScheduleAllFiles();
+	void ScheduleSettingsSave();
+
+	void Flush();
+	bool HasPending() const { return !PendingFiles.IsEmpty() || AllFiles.IsSet() || SettingsSave.IsSet(); }
+
+private:
+	struct FPendingEvent
+	{
+		double FirstTime = 0.0;
+		double LastTime  = 0.0;
+
+		void Touch( double Now );
+		bool IsSettled( double Now, float QuietWindow, float MaxDelay ) const;
+	};
+
+	bool Tick( float DeltaTime );
+	void EnsureTicking();
+
+	FOnSyncBatchReady OnBatchReady;
+
+	TMap< FString, FPendingEvent > PendingFiles;
+	TOptional< FPendingEvent >     AllFiles;
+	TOptional< FPendingEvent >     SettingsSave;
+
+	float QuietWindow = 0.5f;
+	float MaxDelay    = 5.0f;
+
+	FTSTicker::FDelegateHandle TickHandle;
+};
\ No newline at end of file
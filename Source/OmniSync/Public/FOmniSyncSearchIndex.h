@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOmniSyncSearchIndex
+{
+public:
+	void Reset( const TArray< FString >& InPaths );
+
+	const TArray< int32 >& Query( const FString& Text );
+	int32                  Num() const { return Paths.Num(); }
+
+private:
+	static uint64 GetTrigramKey( const TCHAR* Chars );
+
+	void BuildTrigrams();
+
+	TArray< FString >               Paths;
+	TMap< uint64, TArray< int32 > > Trigrams;
+	bool                            bTrigramsBuilt = false;
+
+	FString         LastQuery;
+	TArray< int32 > LastMatches;
+};
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UOmniSyncSettings.h"
+
+class FOmniSyncSettingsStore
+{
+public:
+	explicit FOmniSyncSettingsStore( const FString& InDirectory );
+
+	bool Load( FConfigFileSettingsStruct& OutSettings, int32& OutJournalRecords );
+
+	// The journal was begun by an older format or ends in a torn record and has to be folded into a new snapshot before anything is appended
+	bool NeedsCompaction() const { return bNeedsCompaction; }
+
+	// Built on the game thread, the bytes are handed to a worker job
+	static TArray< uint8 > MakeSnapshot( const FConfigFileSettingsStruct& Settings );
+	static void            AddEntryRecord( TArray< uint8 >& Records, const FConfigFileSettings& Setting );
+	static void            AddRemoveRecord( TArray< uint8 >& Records, const FString& RelativePath );
+	static void            AddOptionsRecord( TArray< uint8 >& Records, const FConfigFileSettingsStruct& Settings );
+
+	bool WriteSnapshot( const TArray< uint8 >& Snapshot );
+	bool AppendJournal( const TArray< uint8 >& Records );
+
+	static bool ExportJson( const FConfigFileSettingsStruct& Settings, const FString& File );
+	static bool ImportJson( const FString& File, FConfigFileSettingsStruct& OutSettings );
+
+private:
+	static void SerializeOptions( FArchive& Archive, uint32 Version, FConfigFileSettingsStruct& Settings );
+	static void SerializeEntry( FArchive& Archive, FConfigFileSettings& Setting );
+	static void AddRecord( TArray< uint8 >& Records, uint8 Type, TFunctionRef< void( FArchive& ) > Serialize );
+
+	bool ApplyJournal( const TArray< uint8 >& Journal, FConfigFileSettingsStruct& Settings, int32& OutJournalRecords );
+
+	FString SnapshotFile;
+	FString JournalFile;
+	uint32  Generation       = 0;
+	bool    bResetJournal    = false;
+	bool    bNeedsCompaction = false;
+};
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP( TEXT( "OmniSync" ), STATGROUP_OmniSync, STATCAT_Advanced );
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN( TEXT( "Files Scanned" ), STAT_OmniSyncFilesScanned, STATGROUP_OmniSync, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN( TEXT( "Files Hashed" ), STAT_OmniSyncFilesHashed, STATGROUP_OmniSync, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN( TEXT( "Files Copied" ), STAT_OmniSyncFilesCopied, STATGROUP_OmniSync, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN( TEXT( "Files Skipped" ), STAT_OmniSyncFilesSkipped, STATGROUP_OmniSync, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN( TEXT( "Bytes Written" ), STAT_OmniSyncBytesWritten, STATGROUP_OmniSync, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN( TEXT( "Pending Jobs" ), STAT_OmniSyncPendingJobs, STATGROUP_OmniSync, );
+
+UE_TRACE_CHANNEL_EXTERN( OmniSyncChannel );
+
+enum class EOmniSyncOperation : uint8
+{
+	Discover,
+	Push,
+	Pull,
+	Verify,
+	Job,
+	ChangeToStore,
+	Num,
+};
+
+const TCHAR* LexToString( EOmniSyncOperation Operation );
+
+// Power of two buckets over microseconds, recording is lock free so worker threads and ParallelFor bodies can share one histogram
+class FOmniSyncLatencyHistogram
+{
+public:
+	static constexpr int32 NumBuckets = 32;
+
+	void Add( double Seconds );
+	void Reset();
+
+	uint64 Num() const { return Count.load( std::memory_order_relaxed ); }
+	double GetPercentile( double Percentile ) const;
+	double GetMean() const;
+	double GetMax() const { return static_cast< double >( MaxMicroseconds.load( std::memory_order_relaxed ) ) * 1e-6; }
+	uint64 GetBucket( const int32 Bucket ) const { return Buckets[ Bucket ].load( std::memory_order_relaxed ); }
+
+	static double GetBucketUpperBound( int32 Bucket );
+
+private:
+	std::atomic< uint64 > Buckets[ NumBuckets ] = {};
+	std::atomic< uint64 > Count                 = 0;
+	std::atomic< uint64 > TotalMicroseconds     = 0;
+	std::atomic< uint64 > MaxMicroseconds       = 0;
+};
+
+class FOmniSyncStats
+{
+public:
+	static void AddFilesScanned( int32 Count );
+	static void AddFileHashed();
+	static void AddFileCopied();
+	static void AddFileSkipped();
+	static void AddBytesWritten( int64 Bytes );
+	static void AddPendingJobs( int32 Delta );
+
+	static void                             RecordLatency( EOmniSyncOperation Operation, double Seconds );
+	static const FOmniSyncLatencyHistogram& GetHistogram( EOmniSyncOperation Operation );
+
+	static FText GetStatusText();
+	static void  Dump();
+	static void  Reset();
+
+private:
+	static void MarkChanged() { Version.fetch_add( 1, std::memory_order_relaxed ); }
+
+	static std::atomic< uint64 > FilesScanned;
+	static std::atomic< uint64 > FilesHashed;
+	static std::atomic< uint64 > FilesCopied;
+	static std::atomic< uint64 > FilesSkipped;
+	static std::atomic< uint64 > BytesWritten;
+	static std::atomic< int32 >  PendingJobs;
+	static std::atomic< uint32 > Version;
+
+	static FOmniSyncLatencyHistogram Histograms[ static_cast< int32 >( EOmniSyncOperation::Num ) ];
+};
+
+// Times the enclosing scope into one of the operation histograms
+class FOmniSyncLatencyScope
+{
+public:
+	explicit FOmniSyncLatencyScope( const EOmniSyncOperation InOperation )
+		: Operation( InOperation )
+		, StartTime( FPlatformTime::Seconds() )
+	{}
+
+	~FOmniSyncLatencyScope() { FOmniSyncStats::RecordLatency( Operation, FPlatformTime::Seconds() - StartTime ); }
+
+private:
+	EOmniSyncOperation Operation;
+	double             StartTime;
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FFileChangeData;
+
+DECLARE_DELEGATE_OneParam( FOnWatchedFilesChanged, const TArray< FString >& );
+
+// Reports changed .ini and generations files of the watched directories. UOmniSyncSettings schedules pushes only for project files,
+// a change in a store scope directory can at most queue a pull
+class FOmniSyncWatcher
+{
+public:
+	explicit FOmniSyncWatcher( const FOnWatchedFilesChanged& InOnFilesChanged );
+	~FOmniSyncWatcher();
+
+	bool Watch( const FString& Directory );
+	void UnwatchAll();
+
+	bool IsWatching() const { return !WatchedDirectories.IsEmpty(); }
+	bool ConsumeRescanRequest();
+
+private:
+	void OnDirectoryChanged( const TArray< FFileChangeData >& FileChanges );
+
+	FOnWatchedFilesChanged OnFilesChanged;
+
+	TMap< FString, FDelegateHandle > WatchedDirectories;
+
+	bool bRescanRequested = false;
+};
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+
+DECLARE_DELEGATE_OneParam( FOnSyncJobCompleted, bool );
+
+class FOmniSyncWorker : public FRunnable
+{
+public:
+	using FJob = TUniqueFunction< bool( const FThreadSafeBool& bCancelled ) >;
+
+	FOmniSyncWorker();
+	virtual ~FOmniSyncWorker() override;
+
+	uint32 Enqueue( FJob&& Work, const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+
+	void Cancel( uint32 JobId );
+	void CancelAll();
+
+	bool IsIdle() const { return PendingJobs.load() == 0; }
+	void WaitUntilIdle() const;
+
+	virtual uint32 Run() override;
+	virtual void   Stop() override;
+
+private:
+	struct FQueuedJob
+	{
+		uint32              Id = 0;
+		FJob                Work;
+		FOnSyncJobCompleted OnCompleted;
+		double              EnqueueTime = 0.0;
+	};
+
+	TQueue< FQueuedJob, EQueueMode::Mpsc > Queue;
+
+	FRunnableThread* Thread     = nullptr;
+	FEvent*          WakeEvent  = nullptr;
+	FThreadSafeBool  bStopping  = false;
+	FThreadSafeBool  bCancelled = false;
+
+	FCriticalSection CancelLock;
+	TSet< uint32 >   CancelledJobs;
+	uint32           CurrentJobId   = 0;
+	uint32           CancelBeforeId = 0;
+
+	std::atomic< uint32 > NextJobId   = 1;
+	std::atomic< int32 >  PendingJobs = 0;
+};
\ No newline at end of file
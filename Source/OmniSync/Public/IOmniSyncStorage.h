@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UOmniSyncSettings.h"
+
+class IOmniSyncStorage
+{
+public:
+	virtual ~IOmniSyncStorage() = default;
+
+	virtual bool GetHash( EOmniSyncScope Scope, const FString& RelativePath, uint64& OutHash ) = 0;
+	virtual bool Read( EOmniSyncScope Scope, const FString& RelativePath, TArray< uint8 >& OutBytes ) = 0;
+	virtual bool Write( EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash ) = 0;
+
+	virtual TArray< FString > GetRelativePaths( EOmniSyncScope Scope ) = 0;
+
+	// The file holding the stored bytes exactly as they are, empty for backends that encode, pack or layer them
+	virtual FString GetPlainFile( EOmniSyncScope Scope, const FString& RelativePath ) { return FString(); }
+
+	// Persists whatever bookkeeping the backend keeps in memory, called once at the end of a batch. False when writes of the batch
+	// that were held back could not be persisted and are lost
+	virtual bool Flush() = 0;
+};
\ No newline at end of file
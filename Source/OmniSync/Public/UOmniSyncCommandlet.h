@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "UOmniSyncCommandlet.generated.h"
+
+class UOmniSyncSettings;
+
+UCLASS()
+class UOmniSyncCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UOmniSyncCommandlet();
+
+	virtual int32 Main( const FString& Params ) override;
+
+private:
+	static void WaitForJobs( UOmniSyncSettings& Settings );
+};
\ No newline at end of file
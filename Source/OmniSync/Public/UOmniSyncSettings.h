@@ -1,10 +1,28 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "FOmniSyncWorker.h"
 #include "UObject/Object.h"
 
 #include "UOmniSyncSettings.generated.h"
 
+class FOmniSyncDirectoryIndex;
+class FOmniSyncGenerations;
+class FOmniSyncLayerCache;
+struct FOmniSyncDiscoveryRoot;
+class FOmniSyncManifest;
+class FOmniSyncPathRules;
+class FOmniSyncPlan;
+struct FOmniSyncPlanEntry;
+class IOmniSyncStorage;
+class FOmniSyncScheduler;
+class FOmniSyncSettingsStore;
+struct FOmniSyncBatch;
+class FOmniSyncWatcher;
+struct FOmniSyncPulledFile;
+struct FOmniSyncFileReport;
+struct FOmniSyncHistoryVersion;
+
 UENUM( BlueprintType )
 enum class EOmniSyncScope : uint8
 {
@@ -13,6 +31,14 @@ enum class EOmniSyncScope : uint8
 	PerProject,
 };
 
+UENUM( BlueprintType )
+enum class EOmniSyncStorageMode : uint8
+{
+	Files,
+	ContentAddressed,
+	Packed,
+};
+
 USTRUCT( BlueprintType )
 struct FConfigFileSettings
 {
@@ -32,6 +58,9 @@ struct FConfigFileSettings
 
 	UPROPERTY( EditAnywhere )
 	bool bAutoSyncEnabled = true;
+
+	UPROPERTY( EditAnywhere )
+	bool bLayered = false;
 };
 
 USTRUCT()
@@ -41,44 +70,212 @@ struct FConfigFileSettingsStruct
 
 	UPROPERTY( EditAnywhere )
 	TArray< FConfigFileSettings > Settings;
+
+	UPROPERTY( EditAnywhere )
+	bool bHotApplyOnLoad = true;
+
+	UPROPERTY( EditAnywhere )
+	bool bAutoPull = true;
+
+	UPROPERTY( EditAnywhere, meta = ( ClampMin = "0.0", ClampMax = "10.0", Units = "s" ) )
+	float SyncQuietWindowSeconds = 0.5f;
+
+	UPROPERTY( EditAnywhere, meta = ( ClampMin = "0.0", ClampMax = "60.0", Units = "s" ) )
+	float SyncMaxDelaySeconds = 5.0f;
+
+	UPROPERTY( EditAnywhere )
+	EOmniSyncStorageMode StorageMode = EOmniSyncStorageMode::Files;
+
+	UPROPERTY( EditAnywhere )
+	bool bCompressBlobs = true;
+
+	UPROPERTY( EditAnywhere )
+	TArray< FString > ExcludePaths;
+
+	UPROPERTY( EditAnywhere )
+	TArray< FString > IncludePaths;
+
+	UPROPERTY( EditAnywhere, meta = ( ClampMin = "0", ClampMax = "1000" ) )
+	int32 HistoryMaxVersions = 20;
+
+	UPROPERTY( EditAnywhere, meta = ( ClampMin = "1", ClampMax = "65536", Units = "KB" ) )
+	int32 HistoryMaxKilobytes = 256;
 };
 
+DECLARE_DELEGATE_OneParam( FOnVerifyCompleted, const TArray< FOmniSyncFileReport >& );
+DECLARE_DELEGATE_OneParam( FOnHistoryLoaded, const TArray< FOmniSyncHistoryVersion >& );
+DECLARE_MULTICAST_DELEGATE_TwoParams( FOnOmniSyncFilesSynced, const TArray< FString >& /*SyncedFiles*/, const TArray< FString >& /*FailedFiles*/ );
+
 UCLASS()
 class OMNISYNC_API UOmniSyncSettings : public UObject
 {
 	GENERATED_BODY()
 
+	friend class FOmniSyncLayerCache;
+	friend class FOmniSyncLayeredStorage;
+	friend class FOmniSyncSandbox;
+	friend class FOmniSyncScopedStoreRoot;
+
 public:
 	static UOmniSyncSettings* Get();
 
 	void Initialize() { EnableAutoSync(); }
-	void Shutdown() const { DisableAutoSync(); }
+	void Shutdown();
 
 	void DiscoverAndAddConfigFiles();
-	void SaveSettingsToGlobal();
-	void LoadSettingsFromGlobal();
 
-	void OnSettingsChanged();
+	FConfigFileSettings* FindSetting( const FString& RelativePath );
+	FConfigFileSettings& AddSetting( const FString& RelativePath );
+	bool                 RemoveSetting( const FString& RelativePath );
+
+	static FString NormalizeRelativePath( const FString& RelativePath );
+
+	uint32 SaveSettingsToGlobal( const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+	uint32 LoadSettingsFromGlobal( const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+	void   CancelSync( uint32 JobId );
+	uint32 VerifyWithGlobal( bool bWithChanges, const FOnVerifyCompleted& OnCompleted );
+	void   WaitUntilIdle();
+
+	uint32 LoadHistory( const FString& RelativePath, const FOnHistoryLoaded& OnLoaded );
+	uint32 RestoreVersion( const FString& RelativePath, int64 Version, const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+
+	uint32 ExportBundle( const FString& File, const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+	uint32 ImportBundle( const FString& File, const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+	uint32 CollectBlobs( const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted() );
+
+	void OnSettingsChanged( const FString& RelativePath );
+	void OnSettingsChanged( TConstArrayView< FString > RelativePaths );
+	void SetSettingsEnabled( TConstArrayView< FString > RelativePaths, bool bEnabled );
+	void OnOptionsChanged();
+
+	void ExportSettingsJson( const FString& File );
+	void ImportSettingsJson( const FString& File );
+
+	FOnOmniSyncFilesSynced& OnFilesSynced() { return FilesSyncedEvent; }
+
+	static FString GetStoreRootDirectory();
+	static bool    IsStoreRootScoped() { return !ScopedStoreRoot.IsEmpty(); }
+	static FString GetScopedSettingsDirectory( EOmniSyncScope Scope );
+	static FString GetBaseFilePath( EOmniSyncScope Scope, const FString& RelativePath );
 
 	UPROPERTY( EditAnywhere )
 	FConfigFileSettingsStruct ConfigFileSettingsStruct;
 
 private:
-	void SavePluginSettings() const;
+	void SavePluginSettings();
 	void LoadPluginSettings();
+	void RebuildSettingsIndex();
+	void UpdateHistoryLimits();
+
+	void DiscoverAndAddConfigFiles( const TArray< FOmniSyncDiscoveryRoot >& Roots );
 
 	void EnableAutoSync();
-	void DisableAutoSync() const;
+	void DisableAutoSync();
 
 	bool AutoSyncTick( float DeltaTime );
 
-	static bool CopyIniFile( const FString& Source, const FString& Destination );
-	static bool EnsureDirectoryExists( const FString& DirectoryPath );
+	void StartWatching();
+	void WatchScopeDirectories( bool bSucceeded );
+	void OnWatchedFilesChanged( const TArray< FString >& ChangedFiles );
+	void RequestUpstreamPull( EOmniSyncScope Scope );
+	void EnqueueUpstreamPull();
+	void OnSyncBatchReady( const FOmniSyncBatch& Batch );
+
+	FOmniSyncScheduler& GetScheduler();
+
+	bool PushFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry );
+	bool PullFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, FOmniSyncPulledFile* OutPulledFile = nullptr );
+	bool SyncFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, bool bPush, FOmniSyncPulledFile* OutPulledFile = nullptr );
+	bool ReconcileFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, bool bAllowPull, FOmniSyncPulledFile* OutPulledFile = nullptr );
+	void RecordSyncState( const FOmniSyncPlanEntry& Entry );
+	void ForgetSyncState( const FOmniSyncPlanEntry& Entry );
+
+	FOmniSyncFileReport CompareFile( IOmniSyncStorage& Store, const FOmniSyncPlanEntry& Entry, bool bWithChanges );
+
+	bool WriteToStore( IOmniSyncStorage& Store, EOmniSyncScope Scope, const FString& RelativePath, const TArray< uint8 >& Bytes, uint64 Hash );
+	void UpdateLocalManifest( const FString& RelativePath, const FString& LocalFile, uint64 Hash );
+
+	FCriticalSection& GetHistoryLock( EOmniSyncScope Scope, const FString& RelativePath );
+
+	uint32 EnqueueSync( TArray< int32 >&&          EntryIndices,
+	                    bool                       bAutoSyncOnly,
+	                    bool                       bPush,
+	                    const FOnSyncJobCompleted& OnCompleted = FOnSyncJobCompleted(),
+	                    double                     ChangeTime  = 0.0 );
+
+	TSharedRef< const FOmniSyncPlan >      GetSyncPlan();
+	TSharedRef< const FOmniSyncPathRules > GetPathRules();
+	FOmniSyncWorker&                       GetWorker();
+
+	FOmniSyncManifest&    GetLocalManifest();
+	FOmniSyncGenerations& GetGenerations( EOmniSyncScope Scope );
+	int64                 GetStoreGeneration( const FOmniSyncPlanEntry& Entry );
+	FOmniSyncLayerCache&  GetLayerCache();
+	IOmniSyncStorage&     GetStorage( EOmniSyncStorageMode Mode, bool bCompress );
+	bool                  FlushStorage( TConstArrayView< EOmniSyncScope > Scopes );
+	void                  SaveManifests();
+
+	static bool            CopyIniFile( const FString& Source, const FString& Destination );
+	static bool            WriteIniFile( const FString& File, const TArray< uint8 >& Bytes );
+	static TArray< uint8 > EncodeIniText( const FString& Text );
+	static FString         DecodeIniText( const TArray< uint8 >& Bytes );
+	static bool            EnsureDirectoryExists( const FString& DirectoryPath );
 
-	static FString GetScopedSettingsDirectory( EOmniSyncScope Scope );
 	static FString GetPluginSettingsFilePath();
+	static FString GetDirectoryIndexFilePath();
 
 	FTSTicker::FDelegateHandle AutoSyncHandle;
 
+	TSharedPtr< FOmniSyncWorker >  Worker;
+	uint32                         AutoSyncJobId = 0;
+	TSharedPtr< FOmniSyncWatcher > Watcher;
+
+	// Scopes whose generations changed on disk since the last upstream check was queued, one bit per EOmniSyncScope
+	uint8  PendingUpstreamScopes = 0;
+	uint32 UpstreamJobId         = 0;
+
+	TSharedPtr< FOmniSyncScheduler > Scheduler;
+
+	TSharedPtr< FOmniSyncDirectoryIndex > DirectoryIndex;
+
+	TMap< FString, int32 > SettingsIndex;
+
+	TSharedPtr< FOmniSyncSettingsStore > SettingsStore;
+	TSet< FString >                      DirtySettings;
+	int32                                JournalRecords = 0;
+	bool                                 bOptionsDirty  = false;
+	bool                                 bSnapshotDirty = false;
+
+	TSharedPtr< const FOmniSyncPlan > SyncPlan;
+	bool                              bSyncPlanDirty = true;
+
+	// Compiled from ExcludePaths/IncludePaths on first use, reset whenever the options are loaded or edited
+	TSharedPtr< const FOmniSyncPathRules > PathRules;
+
+	// Copied from the options on the game thread, store writes on the worker read them under SyncLock
+	int32 HistoryMaxVersions = 0;
+	int64 HistoryMaxBytes    = 0;
+
+	// History files are read and rewritten outside SyncLock, one of these striped locks guards each of them instead
+	FCriticalSection HistoryLocks[ 16 ];
+
+	// Jobs sync their files in parallel, only the manifest and the store are shared between them
+	FCriticalSection SyncLock;
+
+	TSharedPtr< FOmniSyncManifest > LocalManifest;
+	TSharedPtr< IOmniSyncStorage >  Storage;
+	EOmniSyncStorageMode            ActiveStorageMode        = EOmniSyncStorageMode::Files;
+	bool                            bActiveStorageCompressed = false;
+
+	TMap< EOmniSyncScope, TSharedPtr< FOmniSyncGenerations > > Generations;
+
+	// Outlives the jobs so merged views of layered files are only rebuilt after one of their layers changed
+	TSharedPtr< FOmniSyncLayerCache > LayerCache;
+
+	FOnOmniSyncFilesSynced FilesSyncedEvent;
+
 	static UOmniSyncSettings* Instance;
+
+	// Set by FOmniSyncScopedStoreRoot on the game thread while no job runs, every store path resolves below it until it is cleared
+	static FString ScopedStoreRoot;
 };
\ No newline at end of file